@@ -0,0 +1,183 @@
+#include "ScenarioGenerator.h"
+#include "Simulation.h"
+#include "SelectionPolicy.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+using std::cout;
+using std::endl;
+
+/*
+Microbenchmarks of the engine on generated scenarios.
+
+Every result is printed as one JSON object per line, so runs on different commits can be
+compared with any JSON tool:
+{"bench":"step","scenario":"s10_p1000_...","seed":1,"ops":1200,"ns_per_op":812.5,"ops_per_sec":1230769,"peak_rss_kb":10240}
+
+Every scenario runs in its own forked child, so peak_rss_kb is the high-water mark of that
+scenario so far and not of the largest scenario before it.
+
+usage: bench [--quick] [--seed <n>] [--min-time <seconds>]
+*/
+
+static double minSeconds = 0.2;
+
+// the child starts with the RSS of the parent, which never runs a scenario.
+static long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static void report(const string& bench, const ScenarioSpec& spec, long long ops, double seconds) {
+    double nsPerOp = seconds * 1e9 / ops;
+    cout << "{\"bench\":\"" << bench << "\",\"scenario\":\"" << spec.name() << "\",\"seed\":" << spec.seed
+         << ",\"ops\":" << ops << ",\"ns_per_op\":" << nsPerOp << ",\"ops_per_sec\":" << (long long)(ops / seconds)
+         << ",\"peak_rss_kb\":" << peakRssKb() << "}" << endl;
+}
+
+// Calls body in growing batches until minSeconds have passed, then reports the rate.
+template <typename Body>
+static void measure(const string& bench, const ScenarioSpec& spec, Body body) {
+    typedef std::chrono::steady_clock Clock;
+    long long ops = 0;
+    long long batch = 1;
+    Clock::time_point begin = Clock::now();
+    double seconds = 0;
+    while (seconds < minSeconds) {
+        for (long long i = 0; i < batch; i++) {
+            body();
+        }
+        ops += batch;
+        batch *= 2;
+        seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    }
+    report(bench, spec, ops, seconds);
+}
+
+static void runScenario(const ScenarioSpec& spec) {
+    string configFilePath = "/tmp/spl_bench_" + std::to_string(getpid()) + ".txt";
+    ScenarioGenerator(spec).writeTo(configFilePath);
+
+    measure("config_load", spec, [&]() {
+        Simulation loaded(configFilePath);
+    });
+
+    Simulation simulation(configFilePath);
+    std::ostringstream output;
+    simulation.setOutput(output);
+    simulation.step(10);
+    measure("step", spec, [&]() {
+        simulation.step();
+    });
+
+    const vector<FacilityType>& catalog = *simulation.getCatalog();
+    NaiveSelection naive;
+    BalancedSelection balanced(0, 0, 0);
+    EconomySelection economy;
+    SustainabilitySelection sustainability;
+    SelectionPolicy* policies[] = {&naive, &balanced, &economy, &sustainability};
+    for (SelectionPolicy* policy: policies) {
+        measure("select_" + policy->toString(), spec, [&]() {
+            policy->selectFacility(catalog);
+        });
+    }
+
+    measure("backup", spec, [&]() {
+        simulation.saveBackup();
+    });
+    measure("restore", spec, [&]() {
+        simulation.restoreBackup();
+    });
+
+    const PlanSlots& plans = simulation.getPlans();
+    PlanSlots::const_iterator nextPlan = plans.begin();
+    measure("plan_status", spec, [&]() {
+        output.str("");
+        nextPlan->printStatus(output);
+        if (++nextPlan == plans.end()) {
+            nextPlan = plans.begin();
+        }
+    });
+    measure("close", spec, [&]() {
+        output.str("");
+        simulation.close();
+    });
+
+    std::remove(configFilePath.c_str());
+}
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--quick") {
+            quick = true;
+        }else if (argument == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        }else if (argument == "--min-time" && i + 1 < argc) {
+            minSeconds = std::stod(argv[++i]);
+        }else {
+            cout << "usage: bench [--quick] [--seed <n>] [--min-time <seconds>]" << endl;
+            return 1;
+        }
+    }
+
+    // one dimension at a time around a base scenario.
+    ScenarioSpec base;
+    base.seed = seed;
+    base.numOfSettlements = quick ? 10 : 100;
+    base.numOfPlans = quick ? 100 : 10000;
+    base.numOfFacilities = quick ? 16 : 128;
+
+    vector<ScenarioSpec> scenarios;
+    scenarios.push_back(base);
+    for (int numOfPlans: quick ? vector<int>{1000} : vector<int>{1000, 100000}) {
+        ScenarioSpec spec = base;
+        spec.numOfPlans = numOfPlans;
+        scenarios.push_back(spec);
+    }
+    for (int numOfFacilities: quick ? vector<int>{128} : vector<int>{16, 1024}) {
+        ScenarioSpec spec = base;
+        spec.numOfFacilities = numOfFacilities;
+        scenarios.push_back(spec);
+    }
+    for (int numOfSettlements: quick ? vector<int>{1000} : vector<int>{10, 10000}) {
+        ScenarioSpec spec = base;
+        spec.numOfSettlements = numOfSettlements;
+        scenarios.push_back(spec);
+    }
+    for (int policy = 0; policy < 4; policy++) {
+        ScenarioSpec spec = base;
+        spec.policyMix = {0, 0, 0, 0};
+        spec.policyMix[policy] = 1;
+        scenarios.push_back(spec);
+    }
+    for (int type = 0; type < 3; type++) {
+        ScenarioSpec spec = base;
+        spec.settlementTypeMix = {0, 0, 0};
+        spec.settlementTypeMix[type] = 1;
+        scenarios.push_back(spec);
+    }
+
+    for (const ScenarioSpec& spec: scenarios) {
+        cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            runScenario(spec);
+            cout.flush();
+            _exit(0);
+        }
+        int status = 0;
+        if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "scenario " << spec.name() << " failed" << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
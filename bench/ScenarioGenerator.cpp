@@ -0,0 +1,72 @@
+#include "ScenarioGenerator.h"
+#include <sstream>
+#include <fstream>
+
+static const char* policyNames[] = {"nve", "bal", "eco", "env"};
+
+ScenarioSpec:: ScenarioSpec(): seed(1), numOfSettlements(10), numOfPlans(100), numOfFacilities(16),
+policyMix({1, 1, 1, 1}), settlementTypeMix({1, 1, 1}) {}
+
+string ScenarioSpec:: name() const {
+    std::ostringstream out;
+    out << "s" << numOfSettlements << "_p" << numOfPlans << "_f" << numOfFacilities << "_pol";
+    for (int weight: policyMix) {
+        out << "-" << weight;
+    }
+    out << "_type";
+    for (int weight: settlementTypeMix) {
+        out << "-" << weight;
+    }
+    return out.str();
+}
+
+ScenarioGenerator:: ScenarioGenerator(const ScenarioSpec& spec): spec(spec), state(spec.seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+uint64_t ScenarioGenerator:: next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+int ScenarioGenerator:: uniform(int low, int high) {
+    return low + (int)(next() % (uint64_t)(high - low + 1));
+}
+
+int ScenarioGenerator:: weighted(const vector<int>& weights) {
+    int total = 0;
+    for (int weight: weights) {
+        total += weight;
+    }
+    int pick = uniform(0, total - 1);
+    for (size_t i = 0; i < weights.size(); i++) {
+        if (pick < weights[i]) {
+            return (int)i;
+        }
+        pick -= weights[i];
+    }
+    return 0;
+}
+
+string ScenarioGenerator:: generate() {
+    std::ostringstream out;
+    out << "# generated scenario " << spec.name() << " seed " << spec.seed << "\n";
+    for (int i = 0; i < spec.numOfSettlements; i++) {
+        out << "settlement S" << i << " " << weighted(spec.settlementTypeMix) << "\n";
+    }
+    for (int i = 0; i < spec.numOfFacilities; i++) {
+        int category = i < 3 ? i : uniform(0, 2);
+        out << "facility F" << i << " " << category << " " << uniform(1, 8) << " " << uniform(0, 5)
+            << " " << uniform(0, 5) << " " << uniform(0, 5) << "\n";
+    }
+    for (int i = 0; i < spec.numOfPlans; i++) {
+        out << "plan S" << uniform(0, spec.numOfSettlements - 1) << " " << policyNames[weighted(spec.policyMix)] << "\n";
+    }
+    return out.str();
+}
+
+bool ScenarioGenerator:: writeTo(const string& configFilePath) {
+    std::ofstream outputFile(configFilePath);
+    outputFile << generate();
+    return (bool)outputFile;
+}
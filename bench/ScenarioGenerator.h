@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+using std::string;
+using std::vector;
+
+// Shape of a generated scenario. The mixes are relative weights, indexed like the enums and policy names.
+struct ScenarioSpec {
+    ScenarioSpec();
+    uint64_t seed;
+    int numOfSettlements;
+    int numOfPlans;
+    int numOfFacilities;
+    vector<int> policyMix;         //nve, bal, eco, env
+    vector<int> settlementTypeMix; //village, city, metropolis
+    string name() const;
+};
+
+/*
+Writes config files in the format of config_file.txt for benchmarks.
+
+The same spec always produces the same file: the generator uses its own xorshift
+generator instead of the standard distributions, whose output differs between libraries.
+Every facility category gets at least one facility, so eco and env plans can always select.
+*/
+class ScenarioGenerator {
+    public:
+        explicit ScenarioGenerator(const ScenarioSpec& spec);
+        string generate();
+        bool writeTo(const string& configFilePath);
+
+    private:
+        const ScenarioSpec spec;
+        uint64_t state;
+        uint64_t next();
+        int uniform(int low, int high); //inclusive
+        int weighted(const vector<int>& weights);
+};
@@ -1,10 +1,10 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <iosfwd>
 class Simulation;
 enum class SettlementType;
 enum class FacilityCategory;
-extern Simulation* backup;
 using namespace std;
 
 enum class ActionStatus{
@@ -22,7 +22,7 @@ class BaseAction{
 
     protected:
         void complete();
-        void error(string errorMsg);
+        void error(string errorMsg, std::ostream& out);
         const string& getErrorMsg() const;
 
     private:
@@ -142,3 +142,139 @@ class RestoreSimulation : public BaseAction {
         const string toString() const override;
     private:
 };
+
+class EndPlan : public BaseAction {
+    public:
+        EndPlan(int planId);
+        void act(Simulation& simulation) override;
+        EndPlan* clone() const override;
+        const string toString() const override;
+    private:
+        const int planId;
+};
+
+class PrintTopPlans : public BaseAction {
+    public:
+        PrintTopPlans(int numOfPlans, const string& scoreKind); //scoreKind is lq, eco, env or total.
+        void act(Simulation& simulation) override;
+        PrintTopPlans* clone() const override;
+        const string toString() const override;
+    private:
+        const int numOfPlans;
+        const string scoreKind;
+};
+
+class PrintAggregates : public BaseAction {
+    public:
+        PrintAggregates(const string& grouping); //by=policy, by=settlement or by=type.
+        void act(Simulation& simulation) override;
+        PrintAggregates* clone() const override;
+        const string toString() const override;
+    private:
+        const string grouping;
+};
+
+class PrintPlans : public BaseAction {
+    public:
+        PrintPlans(const string& range, const string& fields, bool binary); //range is all, <id> or <first>-<last>, fields is fields=<name>,...
+        void act(Simulation& simulation) override;
+        PrintPlans* clone() const override;
+        const string toString() const override;
+    private:
+        const string range;
+        const string fields;
+        const bool binary;
+};
+
+class WhatIf : public BaseAction {
+    public:
+        WhatIf(int planId, const string& policy, int numOfSteps); //policy is nve, bal, eco, env or all.
+        void act(Simulation& simulation) override;
+        WhatIf* clone() const override;
+        const string toString() const override;
+    private:
+        const int planId;
+        const string policy;
+        const int numOfSteps;
+};
+
+class Optimize : public BaseAction {
+    public:
+        Optimize(int planId, int horizon, const string& objective); //objective is lq, eco, env, total, min or w=<lq>,<eco>,<env>.
+        void act(Simulation& simulation) override;
+        Optimize* clone() const override;
+        const string toString() const override;
+    private:
+        const int planId;
+        const int horizon;
+        const string objective;
+};
+
+class Subscribe : public BaseAction {
+    public:
+        Subscribe(const string& filePath); //"" streams the events to the simulation output, otherwise they are appended to the file.
+        void act(Simulation& simulation) override;
+        Subscribe* clone() const override;
+        const string toString() const override;
+    private:
+        const string filePath;
+};
+
+class Unsubscribe : public BaseAction {
+    public:
+        Unsubscribe(int subscriberId);
+        void act(Simulation& simulation) override;
+        Unsubscribe* clone() const override;
+        const string toString() const override;
+    private:
+        const int subscriberId;
+};
+
+class Record : public BaseAction {
+    public:
+        Record(const string& filePath, int interval, bool delta, const vector<int>& planIds); //no planIds records every plan.
+        void act(Simulation& simulation) override;
+        Record* clone() const override;
+        const string toString() const override;
+    private:
+        const string filePath;
+        const int interval;
+        const bool delta;
+        const vector<int> planIds;
+};
+
+class StopRecording : public BaseAction {
+    public:
+        StopRecording();
+        void act(Simulation& simulation) override;
+        StopRecording* clone() const override;
+        const string toString() const override;
+};
+
+class PrintMemory : public BaseAction {
+    public:
+        PrintMemory();
+        void act(Simulation& simulation) override;
+        PrintMemory* clone() const override;
+        const string toString() const override;
+};
+
+class SetMemoryBudget : public BaseAction {
+    public:
+        SetMemoryBudget(const string& budget); //a number of bytes, or off.
+        void act(Simulation& simulation) override;
+        SetMemoryBudget* clone() const override;
+        const string toString() const override;
+    private:
+        const string budget;
+};
+
+class PrintStats : public BaseAction {
+    public:
+        PrintStats(const string& argument); //"" prints, "reset" clears, "on" and "off" switch the counters.
+        void act(Simulation& simulation) override;
+        PrintStats* clone() const override;
+        const string toString() const override;
+    private:
+        const string argument;
+};
@@ -4,7 +4,20 @@
 #include <sstream>
 #include <string>
 
+// One argument of a line, pointing into the line it was read from. Valid while that line is unchanged.
+struct ArgumentView {
+    const char* data;
+    size_t length;
+    bool operator== (const char* word) const;
+    bool operator!= (const char* word) const;
+    std::string toString() const;
+    int toInt() const; //parses like std::stoi and throws the same exceptions.
+};
+
+std::ostream& operator<< (std::ostream& out, const ArgumentView& argument);
+
 class Auxiliary{
     public:
         static std::vector<std::string> parseArguments(const std::string& line);
+        static void parseArguments(const std::string& line, std::vector<ArgumentView>& arguments);
 };
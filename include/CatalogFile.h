@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Facility.h"
+using std::string;
+using std::vector;
+
+/*
+A facility catalog compiled into a binary file, a pre-parsed load format.
+
+The file holds a header, one packed record per facility and a string table with the
+names. Loading it reads the file in one go and builds the facilities from the records
+without any text parsing. The facilities are then ordinary FacilityTypes owned by the
+process, so processes that load the same file each hold their own copy.
+*/
+class CatalogFile {
+    public:
+        static bool compile(const vector<FacilityType>& facilities, const string& path);
+        static bool load(const string& path, vector<FacilityType>& facilities); //appends, false and unchanged if the file is missing or malformed.
+
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t numOfFacilities;
+            uint32_t stringTableSize;
+        };
+        struct Record {
+            uint32_t nameOffset; //into the string table.
+            uint32_t nameLength;
+            int32_t price;
+            int32_t lifeQualityScore;
+            int32_t economyScore;
+            int32_t environmentScore;
+            uint32_t category;
+        };
+};
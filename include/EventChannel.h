@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <iosfwd>
+using std::string;
+using std::vector;
+
+enum class PlanEventType {
+    FACILITY_STARTED,
+    FACILITY_OPERATIONAL,
+    STATUS_CHANGED,
+    POLICY_CHANGED,
+};
+
+struct PlanEvent {
+    PlanEvent(PlanEventType type, int planId, const string& detail): type(type), planId(planId), detail(detail) {}
+    PlanEventType type;
+    int planId;
+    string detail; //the facility name, the new plan status or the new policy.
+};
+
+std::ostream& operator<< (std::ostream& out, const PlanEvent& event);
+
+/*
+Collects the events plans raise while a step or a policy change runs, and hands them
+to every subscriber as one batch when it ends, so consumers see only what changed.
+
+Plans hold a pointer to the channel of their simulation and raise nothing without one,
+the simulation only creates a channel once someone subscribes.
+*/
+class EventChannel {
+    public:
+        typedef std::function<void(const vector<PlanEvent>& batch, std::ostream& output)> Subscriber; //output is the simulation's output.
+        EventChannel();
+        int subscribe(const Subscriber& subscriber); //returns an ID for unsubscribe.
+        bool unsubscribe(int subscriberId);
+        bool hasSubscribers() const;
+        void raise(PlanEventType type, int planId, const string& detail);
+        void flush(std::ostream& output); //delivers the pending batch, if any.
+        size_t memoryUsage() const; //heap bytes of the subscribers and pending events.
+
+    private:
+        vector<std::pair<int, Subscriber>> subscribers;
+        int nextSubscriberId;
+        vector<PlanEvent> pending;
+};
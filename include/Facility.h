@@ -43,6 +43,7 @@ class Facility: public FacilityType {
         const string& getSettlementName() const;
         const int getTimeLeft() const;
         void step();
+        void advance(int numOfSteps); //same as numOfSteps calls to step().
         void setStatus(FacilityStatus status);
         const FacilityStatus& getStatus() const;
         const string toString() const;
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+using std::string;
+using std::vector;
+
+/*
+An append-only file holding the names of the facilities plans have completed, so a plan
+keeps only its facilities under construction in memory.
+
+Every record links to the previous record of the same plan, a plan only remembers the
+position of its last one and reading its history visits its own records alone. A record
+header holds the size of the previous record too, so each record is read with one pread.
+Records are never changed, so copies of a plan share them and only copy that position.
+Only the history moves to the file, the rest of a plan can move to a PlanStore.
+*/
+class FacilityHistory {
+    public:
+        static const int64_t none = -1; //the offset of the history of a plan that completed nothing.
+        // The last record of a history.
+        struct Position {
+            Position(): offset(none), size(0) {}
+            int64_t offset;
+            uint32_t size; //of the header and the name.
+            bool operator== (const Position& other) const;
+            bool operator!= (const Position& other) const;
+        };
+        static std::shared_ptr<FacilityHistory> open(const string& filePath); //nullptr if the file cannot be created.
+        bool append(Position& last, const string& facilityName); //safe to call from several threads, moves last to the new record. False if it cannot be written, last is then unchanged.
+        void read(const Position& last, vector<string>& facilityNames) const; //the facilities of a history, oldest first.
+        int64_t size() const;
+        //rule of 5.
+        FacilityHistory(const FacilityHistory& other) = delete;
+        FacilityHistory& operator= (const FacilityHistory& other) = delete;
+        ~FacilityHistory();
+
+    private:
+        struct RecordHeader {
+            int64_t previous;
+            uint32_t previousSize;
+            uint32_t nameLength;
+        };
+        FacilityHistory(int fd);
+        const int fd;
+        std::atomic<int64_t> end;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+// One hosted simulation with its own queue of pending command lines.
+struct Tenant {
+    Tenant(const string& name, const string& configFilePath);
+    Tenant(const Tenant& other) = delete;
+    Tenant& operator= (const Tenant& other) = delete;
+    const string name;
+    Simulation simulation;
+    std::mutex queueLock;
+    std::deque<string> commands;
+    bool scheduled; //queued for, or running on, a worker. Guarded by queueLock.
+    bool closed;    //only touched by the worker that runs the tenant.
+};
+
+/*
+Runs many independent simulations in one process.
+
+The tenants file lists "tenant <name> <config_path>" lines. Every input line is
+"<tenant name> <command>", the command is queued for that tenant and a pool of
+workers runs the tenants with pending commands, each tenant on one worker at a time,
+so its commands run in order. Every report line is printed prefixed with "<tenant name>: ".
+Tenants whose configs define the same facilities share one catalog.
+*/
+class Host {
+    public:
+        Host(const string& tenantsFilePath, int numOfWorkers);
+        void start();
+        int getNumOfTenants() const;
+        int getNumOfSharedCatalogs() const;
+        //rule of 5.
+        Host(const Host& other) = delete;
+        Host& operator= (const Host& other) = delete;
+        ~Host();
+
+    private:
+        vector<Tenant*> tenants;
+        std::map<string, Tenant*> tenantsByName;
+        vector<std::shared_ptr<vector<FacilityType>>> catalogs; //distinct catalogs loaded so far.
+        const int numOfWorkers;
+        std::mutex readyLock;
+        std::condition_variable readyChanged;
+        std::deque<Tenant*> ready;
+        int busyWorkers;
+        bool stopping;
+        std::mutex outputLock;
+        void shareCatalog(Tenant& tenant);
+        void submit(Tenant& tenant, const string& command);
+        void runWorker();
+        void runCommands(Tenant& tenant);
+        void print(const Tenant& tenant, const string& report);
+};
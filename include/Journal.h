@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+/*
+An append-only file of the commands that changed a simulation, replayed on start so a
+crash loses nothing the simulation acknowledged.
+
+append adds a command to the pending group and commit writes the group and makes it
+durable with a single fdatasync, so a burst of commands costs one sync. The simulation
+commits whenever it waits for input and before a command that shows state, and holds
+what the journaled commands print until their group is committed. Commands
+are stored one per line, and a torn last line left by a crash is dropped when the journal
+is opened.
+*/
+class Journal {
+    public:
+        static Journal* open(const string& filePath, vector<string>& commands); //nullptr if the file cannot be opened. commands receives what earlier runs journaled, oldest first.
+        void append(const string& command);
+        bool commit(); //false if the group could not be made durable.
+        //rule of 5.
+        Journal(const Journal& other) = delete;
+        Journal& operator= (const Journal& other) = delete;
+        ~Journal(); //commits and closes the file.
+
+    private:
+        Journal(int fd);
+        const int fd;
+        string pending; //appended but not yet written.
+        bool unsynced; //written since the last sync.
+        bool write(); //helper method, writes pending without syncing.
+};
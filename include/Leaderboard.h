@@ -0,0 +1,50 @@
+#pragma once
+#include <set>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+class Plan;
+
+enum class ScoreKind {
+    LIFE_QUALITY,
+    ECONOMY,
+    ENVIRONMENT,
+    TOTAL,
+};
+
+// The three scores of a plan, as last seen by the leaderboard.
+struct PlanScores {
+    PlanScores(): lifeQuality(0), economy(0), environment(0) {}
+    explicit PlanScores(const Plan& plan);
+    int lifeQuality;
+    int economy;
+    int environment;
+    int get(ScoreKind kind) const;
+    bool operator== (const PlanScores& other) const;
+    bool operator!= (const PlanScores& other) const;
+};
+
+/*
+Plans ordered by each of their scores, best first and ties broken by lower planId.
+
+The simulation updates it only for plans whose scores changed in a tick, each update
+costs O(log n), and reading the best k plans walks k entries of one index.
+*/
+class Leaderboard {
+    public:
+        Leaderboard();
+        void insert(int planId, const PlanScores& scores);
+        void update(int planId, const PlanScores& before, const PlanScores& after);
+        void erase(int planId, const PlanScores& scores);
+        vector<std::pair<int, int>> top(ScoreKind kind, int k) const; //(planId, score) pairs, best first.
+        void clear();
+        size_t memoryUsage() const; //heap bytes of the indexes.
+        static bool scoreKindFromString(const string& name, ScoreKind& kind); //lq, eco, env or total.
+        static string scoreKindToString(ScoreKind kind);
+
+    private:
+        static const int numOfKinds = 4;
+        std::set<std::pair<int, int>> indexes[numOfKinds]; //(-score, planId), so the best plan comes first.
+};
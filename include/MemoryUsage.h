@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <iosfwd>
+using std::string;
+using std::vector;
+
+class SelectionPolicy;
+
+// Bytes held by each part of a simulation, see Simulation::getMemoryUsage.
+struct MemoryUsage {
+    MemoryUsage();
+    size_t catalog; //0 for a catalog shared with the simulation being measured against.
+    size_t plans;
+    size_t facilities;
+    size_t policies;
+    size_t settlements;
+    size_t actionsLog; //estimated from the text of the actions.
+    size_t indexes; //leaderboard and rollups.
+    size_t events;
+    size_t recorder;
+    size_t backup;
+    size_t total() const;
+    void print(std::ostream& out) const;
+    //helpers, the heap bytes behind a value.
+    static size_t ofString(const string& text);
+    static size_t ofPolicy(const SelectionPolicy* policy);
+    static size_t ofTreeNodes(size_t numOfNodes, size_t valueSize);
+    template<typename T>
+    static size_t ofVector(const vector<T>& items) {
+        return items.capacity() * sizeof(T);
+    }
+};
+
+/*
+A temporary file holding actions moved out of the actions log, one line per action
+with its text, its status and the status its clones have.
+
+The file is only appended to and is shared by a simulation and its copies, each of
+which keeps the byte ranges that belong to its own log.
+*/
+class ActionSpill {
+    public:
+        static ActionSpill* create(); //nullptr if no temporary file can be made.
+        std::pair<long, long> append(const string& lines); //returns the byte range written.
+        void read(const std::pair<long, long>& range, vector<string>& lines) const;
+        //rule of 5.
+        ActionSpill(const ActionSpill& other) = delete;
+        ActionSpill& operator= (const ActionSpill& other) = delete;
+        ~ActionSpill();
+
+    private:
+        ActionSpill(FILE* file);
+        FILE* file;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Leaderboard.h"
+using std::string;
+using std::vector;
+
+class Plan;
+
+// What a schedule is judged by: one score, the sum, the weakest category or a weighted sum.
+struct Objective {
+    Objective();
+    int lifeQualityWeight;
+    int economyWeight;
+    int environmentWeight;
+    bool minimum; //judge by the lowest of the three scores, ignoring the weights.
+    long long evaluate(const PlanScores& scores) const;
+    static bool fromString(const string& name, Objective& objective); //lq, eco, env, total, min or w=<lq>,<eco>,<env>.
+};
+
+// One policy switch, step steps from now.
+struct ScheduleEntry {
+    int step;
+    string policy;
+};
+
+struct OptimizerResult {
+    OptimizerResult(): schedule(), scores(), value(0), baseline(), baselineValue(0) {}
+    vector<ScheduleEntry> schedule;
+    PlanScores scores; //at the end of the horizon under the schedule.
+    long long value;
+    PlanScores baseline; //at the end of the horizon under the current policy.
+    long long baselineValue;
+};
+
+/*
+Searches for the sequence of policy switches that maximizes an objective over a horizon.
+
+A switch may happen now and after every step that completes a facility. The search is a
+beam search: every node of the beam is expanded into one child per policy, each child is
+run until its next completion, and every child is then rolled out to the horizon under
+its own policy. A rollout is a complete schedule, so the best rollout seen is always a
+valid answer, and it also ranks the children for the next beam. Children that reach a
+plan state already seen are dropped, and rollouts are memoized by plan state. Expansions
+of a round run on a pool of threads.
+*/
+class PolicyOptimizer {
+    public:
+        PolicyOptimizer(const Plan& plan, int horizon, const Objective& objective, int beamWidth);
+        OptimizerResult run(int numOfThreads);
+        PolicyOptimizer(const PolicyOptimizer& other) = delete;
+        PolicyOptimizer& operator= (const PolicyOptimizer& other) = delete;
+
+    private:
+        struct Node {
+            Node(): plan(), time(0), schedule(), rollout(), value(0) {}
+            std::shared_ptr<Plan> plan;
+            int time;
+            vector<ScheduleEntry> schedule;
+            PlanScores rollout;
+            long long value;
+        };
+        const Plan& plan;
+        const int horizon;
+        const Objective objective;
+        const int beamWidth;
+        std::mutex lock;
+        std::unordered_map<string, PlanScores> rollouts; //rollout scores by time and plan state.
+        PlanScores rollOut(const Plan& plan, int time);
+        Node expand(const Node& parent, const string& policy);
+};
@@ -3,7 +3,11 @@
 #include "Facility.h"
 #include "Settlement.h"
 #include "SelectionPolicy.h"
+#include "EventChannel.h"
+#include "FacilityHistory.h"
+#include "PlanStore.h"
 #include <iostream>
+#include <memory>
 using namespace std;
 using std::vector;
 
@@ -12,27 +16,75 @@ enum class PlanStatus {
     BUSY,
 };
 
+/*
+The part of a plan that decides how it evolves. Twin plans, plans in the same state, share
+one PlanState: stepping one of them steps them all, and a twin that is about to change
+alone first takes its own copy, see Plan::leaveTwins. A stored plan has no PlanState in
+memory, its state is in a PlanStore record, see Plan::setStore.
+*/
+struct PlanState {
+    PlanState(int planId, SelectionPolicy* selectionPolicy);
+    PlanState(const PlanState& other); //copies the policy and the facilities, keeps the twins.
+    PlanState& operator= (const PlanState& other) = delete;
+    ~PlanState();
+    SelectionPolicy* selectionPolicy;
+    PlanStatus status;
+    vector<Facility*> facilities;
+    vector<Facility*> underConstruction;
+    FacilityHistory::Position lastArchived; //the last facility moved to history.
+    int numOfArchived;
+    int life_quality_score, economy_score, environment_score;
+    vector<int> twins; //the IDs of the plans sharing this state, ascending.
+};
+
 class Plan {
     public:
         Plan(const int planId, const Settlement& settlement, SelectionPolicy* selectionPolicy, const vector<FacilityType>& facilityOptions);
         const int getlifeQualityScore() const;
         const int getEconomyScore() const;
         const int getEnvironmentScore() const;
-        void setSelectionPolicy(SelectionPolicy* selectionPolicy);
-        void step();
-        void printStatus() const;
-        const vector<Facility*>& getFacilities() const;
+        void setSelectionPolicy(SelectionPolicy* selectionPolicy); //leaves the twins first.
+        void step(); //steps the twins too, see getTwins.
+        void advance(int numOfSteps); //same as numOfSteps calls to step(), skipping ticks in which nothing happens.
+        int advanceToCompletion(int maxSteps); //like advance, but stops after the first step that completes a facility. Returns the steps taken.
+        void printStatus(std::ostream& out) const;
+        const vector<Facility*>& getFacilities() const; //the completed facilities kept in memory, see setHistory. None for a stored plan.
+        void getBuildingNames(vector<string>& names) const; //the names of the facilities under construction.
+        void countUnderConstruction(int counts[3]) const; //the facilities under construction, per FacilityCategory.
+        void getBuiltNames(vector<string>& names) const; //the names of the completed facilities, oldest first, those in history too.
         void addFacility(Facility* facility);
         const string toString() const;
-        const SelectionPolicy* getSelectionPolicy() const; //helper method.
+        std::shared_ptr<const SelectionPolicy> getSelectionPolicy() const; //helper method, read from the record of a stored plan.
         const string statusToString() const; //helper method
-        void printplan() const;
-        //helper constructor for simulation copy.
+        const string stateToString() const; //everything that decides the next steps, equal for plans that will evolve alike.
+        void printplan(std::ostream& out) const;
+        void appendReport(string& text) const; //appends what printplan prints.
+        int getPlanId() const; //helper method
+        PlanStatus getStatus() const; //helper method
+        bool isTwinOf(const Plan& other) const; //same state and build capacity, so both plans print and evolve alike.
+        void joinTwin(const Plan& twin); //shares the state of twin, which isTwinOf this plan.
+        void leaveTwins(); //takes its own copy of a shared state.
+        void quitTwins(); //leaves the twins of a plan about to end, without copying the state.
+        const vector<int>& getTwins() const; //the IDs of the plans sharing this plan's state, this one included, ascending. Empty for a stored plan.
+        bool hasTwins() const; //shares its state with other plans. A stored plan never does.
+        bool leadsTwins() const; //the first of its twins, the one the simulation steps.
+        void setFacilityOptions(const vector<FacilityType>& facilityOptions); //rebinds to a copied catalog
+        void setEventChannel(EventChannel* events); //where step and setSelectionPolicy raise events, nullptr for none. Copies start with none.
+        void setHistory(FacilityHistory* history); //where completed facilities are moved to, nullptr keeps them in memory. Forks start with none.
+        void setStore(PlanStore* store); //moves the state to a record of store when the record can hold it, nullptr keeps it in memory. Copies start in memory.
+        bool isStored() const; //the state is in a PlanStore record and not in memory.
+        size_t facilitiesMemoryUsage() const; //heap bytes of the facilities and their vectors, shared with the twins.
+        void compact(); //releases the spare capacity of the facility vectors.
+        //fork for projections: shares the settlement and catalog, copies only the facilities under construction and takes selectionPolicy.
+        Plan(const Plan& other, SelectionPolicy* selectionPolicy);
+        //helper constructor for simulation copy, the copy keeps the twins of other until they join it.
         Plan(const Plan& other, const Settlement& settlement, const vector<FacilityType>& facilityOptions);
+        //helper constructor for simulation copy, shares the state of twin, the copy of a twin of other.
+        Plan(const Plan& other, const Settlement& settlement, const Plan& twin);
         // rule of 5.
-        Plan(const Plan& other);
+        Plan(const Plan& other); //has no twins.
         Plan& operator = (const Plan& other) = delete;
-        Plan(Plan&& other);
+        Plan(Plan&& other) noexcept; //noexcept so a growing vector moves plans instead of copying them.
         Plan& operator = (const Plan&& other) = delete;
         ~Plan();
         const Settlement& getSettlement() const;
@@ -41,10 +93,29 @@ class Plan {
     private:
         int plan_id;
         const Settlement& settlement;
-        SelectionPolicy* selectionPolicy;
-        PlanStatus status;
-        vector<Facility*> facilities;
-        vector<Facility*> underConstruction;
-        const vector<FacilityType>& facilityOptions;
-        int life_quality_score, economy_score, environment_score;
-};
\ No newline at end of file
+        const vector<FacilityType>* facilityOptions;
+        EventChannel* events;
+        FacilityHistory* history;
+        PlanStore* store;
+        std::shared_ptr<PlanState> state; //nullptr while the plan is stored.
+        // helper, keeps the state of a stored plan in memory while it changes and stores it again after.
+        class Resident {
+            public:
+                explicit Resident(Plan& plan);
+                Resident(const Resident& other) = delete;
+                Resident& operator= (const Resident& other) = delete;
+                ~Resident();
+            private:
+                Plan& plan;
+                const bool loaded;
+        };
+        std::shared_ptr<const PlanState> view() const; //helper method, the state, read from the record of a stored plan.
+        std::shared_ptr<PlanState> load() const; //helper method, reads the state of a stored plan.
+        void save(); //helper method, moves the state to the record of a plan in a store if the record can hold it.
+        const PlanStore::Record& record() const; //helper method
+        const string toString(const PlanState& current) const; //helper method
+        int idleSteps() const; //helper method
+        void skipIdleSteps(int numOfSteps); //helper method, counts down the facilities under construction.
+        void archive(Facility* facility); //helper method
+        void raise(PlanEventType type, const string& detail) const; //helper method, raises the event for every twin.
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include "Plan.h"
+using std::vector;
+
+/*
+The plans of a simulation in fixed slots, in plan-ID order.
+
+The plan with ID planId lives in slot planId / stride, so finding a plan is an index and
+ending one leaves an empty slot behind instead of moving the later plans. Slots are
+allocated in chunks, so adding plans never moves the ones already there, and a chunk is
+released once every plan in it has ended. Iteration visits the plans that have not ended.
+*/
+class PlanSlots {
+    private:
+        static const size_t chunkSize = 256;
+        struct Chunk {
+            Chunk(): slots(), live(), numOfLive(0) {}
+            typename std::aligned_storage<sizeof(Plan), alignof(Plan)>::type slots[chunkSize];
+            bool live[chunkSize];
+            size_t numOfLive;
+        };
+
+    public:
+        // visits the plans that have not ended, in slot order.
+        template <typename Slots, typename Item>
+        class Iterator: public std::iterator<std::forward_iterator_tag, Item> {
+            public:
+                Iterator(Slots* slots, size_t slot): slots(slots), slot(slot) {skipEnded();}
+                Item& operator* () const {return *slots->at(slot);}
+                Item* operator-> () const {return slots->at(slot);}
+                Iterator& operator++ () {slot++; skipEnded(); return *this;}
+                bool operator== (const Iterator& other) const {return slot == other.slot;}
+                bool operator!= (const Iterator& other) const {return slot != other.slot;}
+            private:
+                Slots* slots;
+                size_t slot;
+                void skipEnded() {slot = slots->nextLive(slot);}
+        };
+        typedef Iterator<PlanSlots, Plan> iterator;
+        typedef Iterator<const PlanSlots, const Plan> const_iterator;
+
+        explicit PlanSlots(int stride); //the number of shards, plan IDs of other shards get no slot.
+        Plan& add(Plan&& plan); //the plan ID must be above the ID of every plan added before.
+        void erase(int planId); //the plan must exist.
+        void clear();
+        Plan* find(int planId); //nullptr if the plan ended or was never added.
+        const Plan* find(int planId) const;
+        Plan* at(size_t slot); //nullptr for an empty slot.
+        const Plan* at(size_t slot) const;
+        size_t slotOf(int planId) const;
+        size_t numOfSlots() const; //one past the slot of the last plan added.
+        size_t size() const; //the plans that have not ended.
+        bool empty() const;
+        size_t memoryUsage() const; //heap bytes of the chunks.
+        void compact(); //releases the spare capacity of the chunk table.
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_iterator lowerBound(int planId) const; //the first plan with an ID of at least planId.
+        //rule of 5.
+        PlanSlots(const PlanSlots& other) = delete;
+        PlanSlots& operator= (const PlanSlots& other) = delete;
+        PlanSlots(PlanSlots&& other);
+        PlanSlots& operator= (PlanSlots&& other);
+        ~PlanSlots();
+
+    private:
+        size_t stride;
+        vector<std::unique_ptr<Chunk>> chunks; //nullptr once every plan in it ended.
+        size_t slotsUsed;
+        size_t numOfPlans;
+        size_t nextLive(size_t slot) const; //helper method, the first slot from slot on that holds a plan.
+};
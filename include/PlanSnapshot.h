@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <functional>
+using std::vector;
+
+class Plan;
+class PlanSlots;
+
+/*
+Copies the plans of a running simulation on a helper thread, as they were when it started.
+
+The helper copies from the last plan to the first. Before changing a plan, the simulation
+calls preserve, which copies that plan itself unless the helper already has, so a step
+runs alongside the copy and waits for no more than the one plan the helper is copying.
+Once every plan is copied the helper hands the copies to finish, one per slot of the
+plans, nullptr for an empty slot.
+
+No plan may be added or ended until wait returns. The plans never move in their slots,
+so the simulation itself may be moved.
+*/
+class PlanSnapshot {
+    public:
+        typedef std::function<Plan*(const Plan& plan)> Copy;
+        typedef std::function<void(vector<Plan*>& copies)> Finish;
+        PlanSnapshot(const PlanSlots& plans, const Copy& copy, const Finish& finish);
+        void preserve(size_t slot); //called before the plan in slot changes.
+        void wait(); //until finish has run.
+        //rule of 5.
+        PlanSnapshot(const PlanSnapshot& other) = delete;
+        PlanSnapshot& operator= (const PlanSnapshot& other) = delete;
+        ~PlanSnapshot(); //waits.
+
+    private:
+        enum State {NOT_COPIED, COPYING, COPIED};
+        vector<const Plan*> plans; //by slot, nullptr for an empty one.
+        const Copy copy;
+        const Finish finish;
+        vector<Plan*> copies;
+        std::unique_ptr<std::atomic<int>[]> states;
+        std::thread helper;
+        bool copyOnce(size_t slot); //false if the other thread claimed the plan first.
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include "Facility.h"
+#include "SelectionPolicy.h"
+using std::string;
+using std::vector;
+
+/*
+A memory-mapped file holding the state of stored plans, one fixed-size record per plan slot.
+
+A stored plan keeps only its Plan object in memory. Its status, scores, policy, history
+position and facilities under construction are in its record, and are read back only
+while the plan changes or prints, see Plan::setStore. Completed facilities go to the
+history file, see FacilityHistory. Stepping visits the records in slot order and the
+mapping is advised as sequential, so the kernel reads ahead and writes back pages as it
+goes and the pages it keeps, not the number of plans, bound the memory in use.
+
+The file is scratch space: it is emptied when opened and a copy of the simulation takes
+a store of its own.
+*/
+class PlanStore {
+    public:
+        static const int maxUnderConstruction = 3; //the highest build capacity.
+        struct Record {
+            int32_t status; //a PlanStatus.
+            int32_t lifeQualityScore;
+            int32_t economyScore;
+            int32_t environmentScore;
+            int64_t lastArchivedOffset; //the FacilityHistory::Position of the last facility moved to history.
+            uint32_t lastArchivedSize;
+            int32_t numOfArchived;
+            PolicyRecord policy;
+            int32_t numOfUnderConstruction;
+            int32_t facilityTypes[maxUnderConstruction]; //indexes into the catalog.
+            int32_t timesLeft[maxUnderConstruction];
+        };
+        static std::shared_ptr<PlanStore> open(const string& filePath, int stride); //empties the file, nullptr if it cannot be created.
+        std::shared_ptr<PlanStore> emptyCopy() const; //a store for a copy of the simulation, in an unlinked file next to this one. nullptr if it cannot be created.
+        bool reserve(int planId); //grows the file to hold the record of planId, false if it cannot.
+        Record& at(int planId); //the record of a plan reserved before.
+        const Record& at(int planId) const;
+        int facilityTypeOf(const vector<FacilityType>& catalog, const string& facilityName); //the index of the facility in catalog, -1 if it is not there.
+        //rule of 5.
+        PlanStore(const PlanStore& other) = delete;
+        PlanStore& operator= (const PlanStore& other) = delete;
+        ~PlanStore();
+
+    private:
+        PlanStore(int fd, const string& filePath, int stride);
+        const int fd;
+        const string filePath;
+        const size_t stride; //the number of shards, plan IDs of other shards get no record.
+        Record* records; //the mapping, nullptr before the first reserve.
+        size_t capacity; //records mapped.
+        const vector<FacilityType>* indexedCatalog; //the catalog facilityTypes was built from.
+        size_t numOfIndexed;
+        std::unordered_map<string, int> facilityTypes; //by name.
+};
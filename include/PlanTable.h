@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+using std::string;
+using std::vector;
+
+class PlanSlots;
+
+/*
+The answer to a bulk plan query: the requested fields of a range of plans, one column per field.
+
+gather visits the plans of the range once and copies only the requested fields, so the
+facility names are only collected when building or built is asked for. The table prints
+as text, a header of field names and one row per plan, or as binary columns after a
+"Fields: <names> Plans: <rows> Bytes: <size>" line. A number column is one int32 per row
+and a text column is a uint32 length followed by the bytes per row, in host byte order.
+*/
+class PlanTable {
+    public:
+        enum Field {ID, SETTLEMENT, POLICY, STATUS, LIFE_QUALITY, ECONOMY, ENVIRONMENT, BUILDING, BUILT};
+        static bool parseFields(const string& names, vector<Field>& fields); //comma separated, false on an unknown or missing name.
+        static bool parseRange(const string& range, int& first, int& last); //all, <id> or <first>-<last>.
+        explicit PlanTable(const vector<Field>& fields);
+        void gather(const PlanSlots& plans, int first, int last); //adds the plans with IDs in [first, last].
+        void appendRow(const PlanTable& other, size_t row); //copies this table's fields of a row of other, which has them all.
+        void print(std::ostream& out) const;
+        void write(std::ostream& out) const;
+        bool read(const string& report); //replaces the table with what write wrote, false if it is malformed.
+        const vector<Field>& getFields() const;
+        size_t getNumOfRows() const;
+        int getPlanId(size_t row) const; //the table must have the id field.
+
+    private:
+        vector<Field> fields;
+        size_t numOfRows;
+        vector<vector<int>> numbers; //per field, filled for id and the scores.
+        vector<vector<string>> texts; //per field, filled for the others.
+        static bool isNumber(Field field);
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include "Leaderboard.h"
+using std::string;
+using std::vector;
+
+class Plan;
+class PlanSlots;
+
+/*
+Appends the scores of the plans to a CSV file every interval ticks.
+
+Each sample is one row per recorded plan: tick,planId,lifeQuality,economy,environment.
+In delta mode a row holds the change since the previous row of the same plan and
+rows that did not change are left out, so summing a plan's rows gives its scores.
+
+Rows are formatted into a front buffer. When it fills up it is swapped with the back
+buffer, which a writer thread writes to the file, so stepping only waits when the
+writer is a whole buffer behind.
+*/
+class Recorder {
+    public:
+        static Recorder* open(const string& filePath, int interval, bool delta, const vector<int>& planIds); //nullptr if the file cannot be opened. No planIds records every plan.
+        int getInterval() const;
+        void record(int tick, const PlanSlots& plans);
+        size_t memoryUsage() const; //heap bytes of the buffers and the delta state.
+        //rule of 5.
+        Recorder(const Recorder& other) = delete;
+        Recorder& operator= (const Recorder& other) = delete;
+        ~Recorder(); //writes what is buffered and closes the file.
+
+    private:
+        Recorder(int interval, bool delta, const vector<int>& planIds);
+        std::ofstream file;
+        const int interval;
+        const bool delta;
+        const std::unordered_set<int> planIds;
+        std::unordered_map<int, PlanScores> previous; //the last row written for each plan, in delta mode.
+        string front;
+        string back;
+        bool backPending; //back holds rows the writer has not written yet.
+        bool stopping;
+        std::mutex lock;
+        std::condition_variable changed;
+        std::thread writer;
+        void handOff();
+        void writeLoop();
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <map>
+#include <string>
+#include <iosfwd>
+#include "Leaderboard.h"
+using std::string;
+
+class Plan;
+
+enum class GroupBy {
+    POLICY,
+    SETTLEMENT,
+    SETTLEMENT_TYPE,
+};
+
+// What a plan contributes to its groups: its scores and its facilities under construction per category.
+struct PlanSummary {
+    PlanSummary();
+    explicit PlanSummary(const Plan& plan);
+    PlanScores scores;
+    int underConstruction[3]; //indexed by FacilityCategory.
+    bool operator== (const PlanSummary& other) const;
+    bool operator!= (const PlanSummary& other) const;
+};
+
+// Sums over the plans of one group.
+struct RollupGroup {
+    RollupGroup();
+    int numOfPlans;
+    PlanScores totals;
+    int underConstruction[3]; //indexed by FacilityCategory.
+    void add(const PlanSummary& summary, int sign);
+    void merge(const RollupGroup& other);
+};
+
+/*
+Score totals and construction counts grouped by selection policy, settlement and settlement type.
+
+The simulation updates them as plans are added, complete or start facilities and change
+policy, so a query reads the groups directly instead of visiting every plan.
+*/
+class Rollups {
+    public:
+        Rollups();
+        void insert(const Plan& plan);
+        void erase(const Plan& plan);
+        void update(const Plan& plan, const PlanSummary& before, const PlanSummary& after);
+        void changePolicy(const Plan& plan, const string& previousPolicy); //moves the plan out of the previousPolicy group.
+        const std::map<string, RollupGroup>& getGroups(GroupBy groupBy) const;
+        size_t memoryUsage() const; //heap bytes of the groups.
+        static bool groupByFromString(const string& name, GroupBy& groupBy); //policy, settlement or type.
+        static void printGroup(std::ostream& out, const string& name, const RollupGroup& group);
+        static bool parseGroup(const string& line, string& name, RollupGroup& group); //reads a line of printGroup.
+
+    private:
+        std::map<string, RollupGroup> byPolicy;
+        std::map<string, RollupGroup> bySettlement;
+        std::map<string, RollupGroup> byType;
+        static void add(std::map<string, RollupGroup>& groups, const string& name, const PlanSummary& summary, int sign);
+};
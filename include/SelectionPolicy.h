@@ -1,22 +1,35 @@
 #pragma once
 #include <vector>
+#include <cstdint>
 #include "Facility.h"
 using std::vector;
 
+// A policy and whatever decides its next selection, in a fixed size, see PlanStore.
+struct PolicyRecord {
+    int32_t kind; //0 nve, 1 bal, 2 eco, 3 env.
+    int32_t state[3]; //the last selected index, or the three scores of bal.
+};
+
 class SelectionPolicy {
     public:
         virtual const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) = 0;
         virtual const string toString() const = 0;
         virtual SelectionPolicy* clone() const = 0;
+        virtual const string stateToString() const = 0; //the name and whatever decides the next selection.
+        virtual PolicyRecord toRecord() const = 0;
+        static SelectionPolicy* fromRecord(const PolicyRecord& record); //nullptr for an unknown kind.
         virtual ~SelectionPolicy() = default;
 };
 
 class NaiveSelection: public SelectionPolicy {
     public:
         NaiveSelection();
+        explicit NaiveSelection(int lastSelectedIndex); //resumes after lastSelectedIndex.
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         NaiveSelection* clone() const override;
+        const string stateToString() const override;
+        PolicyRecord toRecord() const override;
         ~NaiveSelection() override = default;
     private:
         int lastSelectedIndex;
@@ -28,6 +41,8 @@ class BalancedSelection: public SelectionPolicy {
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         BalancedSelection* clone() const override;
+        const string stateToString() const override;
+        PolicyRecord toRecord() const override;
         ~BalancedSelection() override = default;
     private:
         int LifeQualityScore;
@@ -38,9 +53,12 @@ class BalancedSelection: public SelectionPolicy {
 class EconomySelection: public SelectionPolicy {
     public:
         EconomySelection();
+        explicit EconomySelection(int lastSelectedIndex); //resumes after lastSelectedIndex.
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         EconomySelection* clone() const override;
+        const string stateToString() const override;
+        PolicyRecord toRecord() const override;
         ~EconomySelection() override = default;
     private:
         int lastSelectedIndex;
@@ -50,9 +68,12 @@ class EconomySelection: public SelectionPolicy {
 class SustainabilitySelection: public SelectionPolicy {
     public:
         SustainabilitySelection();
+        explicit SustainabilitySelection(int lastSelectedIndex); //resumes after lastSelectedIndex.
         const FacilityType& selectFacility(const vector<FacilityType>& facilitiesOptions) override;
         const string toString() const override;
         SustainabilitySelection* clone() const override;
+        const string stateToString() const override;
+        PolicyRecord toRecord() const override;
         ~SustainabilitySelection() override = default;
     private:
         int lastSelectedIndex;
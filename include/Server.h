@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <list>
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+// A consistent copy of the simulation for read-only queries, with its actions log already rendered.
+struct ServerSnapshot {
+    ServerSnapshot(const Simulation& simulation, long version);
+    const Simulation state;
+    vector<string> log;
+    const long version; //the number of commands run on the simulation before the copy.
+};
+
+// A connected client and the thread serving it.
+struct ServerClient {
+    explicit ServerClient(int fd): fd(fd), finished(false), thread() {}
+    int fd; //-1 once the client is done and the socket is closed.
+    bool finished; //the thread is about to return and can be joined.
+    std::thread thread;
+};
+
+/*
+Serves one simulation to many clients over a Unix domain socket.
+
+Every client sends command lines in the REPL syntax and gets each command's report back,
+followed by an empty line, in the order it sent them. Commands that change the simulation
+run one at a time on the live simulation. planStatus and log are answered from a copy of
+the simulation, which is taken again only when a query needs a newer one: a client that
+ran a command waits for a copy that includes it, other queries refresh the copy only
+when no command is running and never wait. Those read-only queries are not added to
+the actions log. "close" ends the server for all clients.
+*/
+class Server {
+    public:
+        Server(const string& configFilePath, const string& socketPath);
+        bool run(); //false if the socket cannot be opened.
+        //rule of 5.
+        Server(const Server& other) = delete;
+        Server& operator= (const Server& other) = delete;
+        ~Server();
+
+    private:
+        const string socketPath;
+        Simulation simulation;
+        std::mutex writeLock; //held while a command runs on the live simulation.
+        std::shared_ptr<const ServerSnapshot> snapshot; //read and replaced with std::atomic_load/atomic_store.
+        std::atomic<long> version; //the number of commands run, changed under writeLock.
+        std::atomic<bool> running;
+        int listenFd;
+        std::mutex clientsLock;
+        std::list<ServerClient> clients; //a list, so a thread keeps its entry while others are added.
+        void serveClient(ServerClient* client); //closes the socket of the client when it is done.
+        void converse(int clientFd); //helper method, answers commands until the client leaves or closes.
+        void reapClients(); //helper method, joins the threads of clients that are done.
+        string execute(const string& line, long& written); //written receives the version that includes the command.
+        string query(const vector<ArgumentView>& command, long written);
+        std::shared_ptr<const ServerSnapshot> currentSnapshot(long written); //includes the version written.
+        void shutdown();
+};
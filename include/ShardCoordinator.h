@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Action.h"
+#include "Auxiliary.h"
+using std::string;
+using std::vector;
+
+// What a worker sends back for one command: the action status and its report,
+// split into one chunk per plan for "close".
+struct ShardReply {
+    ShardReply(): status(ActionStatus:: COMPLETED), chunks() {}
+    ActionStatus status;
+    vector<string> chunks;
+};
+
+/*
+Runs one simulation split over several worker processes.
+
+Worker i is forked with a pipe pair and owns the plans with planId % numOfShards == i.
+Commands that change the shared settlements, catalog or clock are broadcast to every
+worker, planStatus, changePolicy and endPlan go to the owner of the plan, the per-plan
+reports of "close" and the rows of "plans" are merged back in plan-ID order, the leaderboards of
+"top" are merged by score, the groups of "agg" and the byte counts of "mem" are
+summed and the events of "step" are merged in plan-ID order. The coordinator keeps the actions log
+itself, since no single worker sees every command.
+*/
+class ShardCoordinator {
+    public:
+        ShardCoordinator(const string& configFilePath, int numOfShards);
+        void start();
+        //rule of 5.
+        ShardCoordinator(const ShardCoordinator& other) = delete;
+        ShardCoordinator& operator= (const ShardCoordinator& other) = delete;
+        ~ShardCoordinator();
+
+    private:
+        const string configFilePath;
+        const int numOfShards;
+        vector<int> workerPids;
+        vector<int> toWorker;
+        vector<int> fromWorker;
+        vector<std::pair<string, ActionStatus>> actionsLog;
+        vector<std::pair<string, ActionStatus>> backupLog;
+        bool hasBackup;
+        void spawnWorkers();
+        void stopWorkers();
+        int ownerOf(int planId) const;
+        vector<ShardReply> broadcast(const string& line);
+        ShardReply route(int shard, const string& line);
+        void printMergedClose(const vector<ShardReply>& replies) const;
+        void printMergedTop(const vector<ShardReply>& replies, int numOfPlans) const;
+        void printMergedAggregates(const vector<ShardReply>& replies) const;
+        void printMergedMemory(const vector<ShardReply>& replies) const;
+        void printMergedEvents(const vector<ShardReply>& replies) const;
+        void printMergedPlans(const vector<ShardReply>& replies, const vector<ArgumentView>& command) const;
+        vector<ShardReply> broadcastPlans(const vector<ArgumentView>& command); //asks every worker for binary columns with the plan IDs.
+        static ActionStatus clonedStatus(const std::pair<string, ActionStatus>& entry); //status of a log entry after a Simulation copy.
+        static void runWorker(const string& configFilePath, int shardIndex, int numOfShards, int in, int out);
+};
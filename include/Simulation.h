@@ -1,10 +1,21 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
+#include <iosfwd>
+#include <unordered_map>
 #include "Facility.h"
 #include "Plan.h"
+#include "PlanSlots.h"
 #include "Settlement.h"
 #include "Auxiliary.h"
+#include "Leaderboard.h"
+#include "Rollups.h"
+#include "EventChannel.h"
+#include "Recorder.h"
+#include "MemoryUsage.h"
+#include "PlanSnapshot.h"
+#include "Journal.h"
 using std::string;
 using std::vector;
 
@@ -15,20 +26,53 @@ class SelectionPolicy;
 class Simulation {
     public:
         Simulation(const string& configFilePath);
+        Simulation(const string& configFilePath, int shardIndex, int numOfShards); //keeps only plans with planId % numOfShards == shardIndex.
         void start();
         void addPlan(const Settlement& settlement, SelectionPolicy* selectionPolicy);
         void addAction(BaseAction* action);
         bool addSettlement(Settlement* settlement);
         bool addFacility(FacilityType facility);
+        bool loadCatalog(const string& catalogFilePath); //adds the facilities of a compiled catalog, see CatalogFile.
+        bool setHistoryFile(const string& historyFilePath); //moves completed facilities to the file, see FacilityHistory.
+        bool setStoreFile(const string& storeFilePath); //moves the state of the plans to the file, see PlanStore.
+        bool openJournal(const string& journalFilePath); //replays what earlier runs journaled, then start journals the commands that change state, see Journal.
         bool isSettlementExists(const string& settlementName) const;
         Settlement& getSettlement(const string& settlementName);
         Plan& getPlan(int planID);
+        const Plan& getPlan(int planID) const;
+        void setPlanPolicy(int planId, SelectionPolicy* selectionPolicy); //the plan must exist.
+        bool endPlan(int planId); //frees the plan and stops stepping it, its ID is never given again. False if it does not exist.
+        int subscribe(const EventChannel::Subscriber& subscriber); //called with the plan events of every step and policy change.
+        bool unsubscribe(int subscriberId);
+        bool startRecording(const string& filePath, int interval, bool delta, const vector<int>& planIds); //replaces the current recording, see Recorder.
+        bool stopRecording(); //false if nothing is recorded.
         void step();
+        bool saveBackup(); //false if the copy would not fit in the memory budget.
+        bool restoreBackup(); //false if there is no backup.
+        void step(int numOfSteps); //bulk advance, same result as numOfSteps calls to step().
+        void setLazySteps(bool lazySteps);
+        bool isLazySteps() const;
+        void setBackgroundBackups(bool backgroundBackups);
+        bool isBackgroundBackups() const;
+        void deferSteps(int numOfSteps); //numOfSteps >= 0, flushes first if the pending count would overflow.
+        void flushPendingSteps(); //runs the steps deferred in lazy mode.
         void close();
         void open();
+        MemoryUsage getMemoryUsage() const;
+        void setMemoryBudget(size_t memoryBudget); //0 for none. See relieveMemory.
+        size_t getMemoryBudget() const;
+        void readActionsLog(vector<string>& lines) const; //every logged action with its status, including the spilled ones.
         //helper methods.
         const vector<BaseAction*>& GetActionsLog() const;
         const bool isPlanExists(int planId) const;
+        const PlanSlots& getPlans() const; //the plans that have not ended, in plan-ID order.
+        const Leaderboard& getLeaderboard() const;
+        const Rollups& getRollups() const;
+        std::ostream& getOutput() const;
+        void setOutput(std::ostream& output); //where action reports are written, cout by default.
+        const std::shared_ptr<vector<FacilityType>>& getCatalog() const;
+        bool shareCatalog(const std::shared_ptr<vector<FacilityType>>& catalog); //switches to catalog if it holds the same facilities.
+        static BaseAction* parseAction(const vector<ArgumentView>& command); //nullptr for unknown commands.
         //rule of 5.
         Simulation(const Simulation& other);
         Simulation& operator= (const Simulation& other);
@@ -39,11 +83,48 @@ class Simulation {
     private:
         bool isRunning;
         int planCounter; //For assigning unique plan IDs
+        int shardIndex;
+        int numOfShards;
+        bool lazySteps; //when set, step commands are only counted until something observes the plans.
+        bool backgroundBackups; //when set, backup copies the plans on a helper thread while commands keep running.
+        int pendingSteps;
+        int ticks; //steps simulated so far.
         vector<BaseAction*> actionsLog;
-        vector<Plan> plans;
+        std::shared_ptr<ActionSpill> actionSpill; //created by the first spill, shared between copies.
+        vector<std::pair<long, long>> spilledActions; //ranges of actionSpill holding the start of the log, older than actionsLog.
+        size_t numOfClonedSpills; //the first ranges, spilled before this simulation was copied, show the status of clones.
+        size_t memoryBudget;
+        int actionsSinceRelief; //logged since the memory in use was last measured against the budget.
+        PlanSlots plans;
+        std::unordered_map<string, int> twinCandidates; //by build capacity and state, the last plan added in that state.
+        Leaderboard leaderboard; //plans ordered by score, kept current by step.
+        Rollups rollups; //per-group totals, kept current by step and setPlanPolicy.
         vector<Settlement*> settlements;
-        vector<FacilityType> facilitiesOptions;
+        std::shared_ptr<vector<FacilityType>> facilitiesOptions; //shared between copies, copied on first write.
+        std::shared_ptr<FacilityHistory> history; //shared between copies, nullptr keeps completed facilities in memory.
+        std::shared_ptr<PlanStore> store; //nullptr keeps the plans in memory, copies take a store of their own.
         Settlement* unknownSettlement; //does not exsit.
         Plan* unknownPlan; //does not exsit.
+        std::ostream* output;
+        Simulation* backup; //owned, copies of a simulation start without one.
+        PlanSnapshot* backupInFlight; //owned, copies the plans into backup, nullptr once backup is complete.
+        EventChannel* events; //owned, created by the first subscribe. Copies start without one.
+        Recorder* recorder; //owned, nullptr when not recording. Copies start without one.
+        Journal* journal; //owned, nullptr when not journaling. Copies start without one.
+        Simulation(const Simulation& other, bool copyPlans); //helper constructor, without copyPlans the plans are left empty.
         void Clean(); //helper method
+        void waitForBackup(); //helper method
+        void preserve(const Plan& plan); //helper method, called before a plan and its twins change.
+        void updateTwins(const Plan& plan, const PlanSummary& before); //helper method, after a plan and its twins stepped.
+        void copyPlans(const PlanSlots& others); //helper method
+        void adoptPlans(vector<Plan*>& copies); //helper method
+        void detachCatalog(); //helper method
+        void rebindCatalog(); //helper method
+        void rebindEvents(); //helper method
+        void flushEvents(); //helper method
+        void advancePlans(int numOfSteps); //helper method
+        void commitJournal(std::ostringstream& held, std::ostream& shown); //helper method, then shows what the committed commands printed.
+        static bool isJournaled(const BaseAction& action); //helper method
+        void relieveMemory(); //helper method
+        void spillActions(); //helper method
 };
@@ -0,0 +1,59 @@
+#pragma once
+/*
+Public interface of libsimulation for programs that link the engine directly.
+
+The interface is plain C so that it stays stable across compilers and library versions:
+only this header and the opaque spl_simulation handle are exposed, never the engine classes.
+Calls never print. A failure is reported through the return value.
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct spl_simulation spl_simulation;
+
+typedef struct spl_facility {
+    const char* name;
+    int category;  /* 0=Life Quality, 1=Economy, 2=Environment */
+    int price;
+    int life_quality_score;
+    int economy_score;
+    int environment_score;
+} spl_facility;
+
+/* config_path may be NULL for an empty simulation. */
+spl_simulation* spl_simulation_create(const char* config_path);
+void spl_simulation_destroy(spl_simulation* simulation);
+
+/* When enabled (off by default) every call below that changes the simulation is recorded in the actions log, like the matching REPL command. */
+void spl_simulation_set_action_logging(spl_simulation* simulation, int enabled);
+
+/* Return 1 on success and 0 if the settlement / facility already exists. */
+int spl_simulation_add_settlement(spl_simulation* simulation, const char* name, int type);
+int spl_simulation_add_facility(spl_simulation* simulation, const spl_facility* facility);
+/* Returns how many of the count facilities were added. */
+int spl_simulation_add_facilities(spl_simulation* simulation, const spl_facility* facilities, int count);
+
+/* Returns the new plan ID, or -1 if the settlement does not exist. policy is one of "nve", "bal", "eco", "env". */
+int spl_simulation_add_plan(spl_simulation* simulation, const char* settlement_name, const char* policy);
+/* Returns 1 on success, 0 if the plan does not exist or already uses that policy. */
+int spl_simulation_change_policy(spl_simulation* simulation, int plan_id, const char* policy);
+/* Removes a plan, its ID is not reused. Returns 0 if the plan does not exist. */
+int spl_simulation_end_plan(spl_simulation* simulation, int plan_id);
+
+void spl_simulation_step(spl_simulation* simulation, int num_of_steps);
+
+int spl_simulation_plan_count(const spl_simulation* simulation);
+/* Writes the three scores of one plan to scores[0..2]. Returns 0 if the plan does not exist. */
+int spl_simulation_plan_scores(const spl_simulation* simulation, int plan_id, int scores[3]);
+/* Fills the arrays with the IDs and scores of the first n plans that have not ended, n = min(capacity, plan count), and returns n. Any array may be NULL.
+   Rows are in ascending plan-ID order and row i belongs to plan plan_ids[i]. An ended plan leaves no row, so the rows after it move up. */
+int spl_simulation_read_scores(const spl_simulation* simulation, int* plan_ids, int* life_quality, int* economy, int* environment, int capacity);
+
+/* A snapshot is an independent simulation, it shares the facility catalog until either side adds a facility. */
+spl_simulation* spl_simulation_snapshot(const spl_simulation* simulation);
+void spl_simulation_restore(spl_simulation* simulation, const spl_simulation* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
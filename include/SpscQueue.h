@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+using std::vector;
+
+/*
+Bounded lock-free queue for exactly one producer thread and one consumer thread.
+
+push waits while the queue is full and pop waits while it is empty, so a fast producer
+is held back by a slow consumer instead of growing the queue. Waiting spins briefly and
+then sleeps with a growing back-off, so an idle consumer does not burn a core.
+*/
+template <typename T>
+class SpscQueue {
+    public:
+        explicit SpscQueue(size_t capacity): slots(roundUp(capacity)), mask(slots.size() - 1), head(0), tail(0) {}
+
+        void push(const T& item) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            int attempts = 0;
+            while (position - head.load(std::memory_order_acquire) == slots.size()) {
+                backOff(attempts++);
+            }
+            slots[position & mask] = item;
+            tail.store(position + 1, std::memory_order_release);
+        }
+
+        T pop() {
+            size_t position = head.load(std::memory_order_relaxed);
+            int attempts = 0;
+            while (tail.load(std::memory_order_acquire) == position) {
+                backOff(attempts++);
+            }
+            T item = slots[position & mask];
+            head.store(position + 1, std::memory_order_release);
+            return item;
+        }
+
+        bool empty() const { //on the consumer thread, whether pop would wait.
+            return tail.load(std::memory_order_acquire) == head.load(std::memory_order_relaxed);
+        }
+
+        SpscQueue(const SpscQueue& other) = delete;
+        SpscQueue& operator= (const SpscQueue& other) = delete;
+
+    private:
+        vector<T> slots;
+        const size_t mask;
+        alignas(64) std::atomic<size_t> head; //next slot to pop, written by the consumer.
+        alignas(64) std::atomic<size_t> tail; //next slot to push, written by the producer.
+
+        static size_t roundUp(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            return size;
+        }
+
+        static void backOff(int attempts) {
+            if (attempts < 64) {
+                std::this_thread::yield();
+            }else {
+                int micros = attempts < 74 ? 1 << (attempts - 64) : 1000;
+                std::this_thread::sleep_for(std::chrono::microseconds(micros));
+            }
+        }
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <iosfwd>
+#include <chrono>
+using std::string;
+
+class BaseAction;
+class SelectionPolicy;
+class Simulation;
+
+/*
+Process-wide counters and timers of the engine's hot paths, reported by the "stats" command.
+
+They are compiled in only when SPL_STATS is defined (make STATS=1). Without it the
+SPL_STATS_* macros expand to nothing, so the default build pays nothing on the step path.
+In an instrumented build they can also be switched off at run time with "stats off", after which
+every site costs one relaxed load and neither reads the clock nor allocates.
+All counters are relaxed atomics, so sweep, host and server threads can update them together.
+*/
+class Stats {
+    public:
+        enum Counter {
+            FACILITIES_SELECTED,  //followed by one slot per policy: nve, bal, eco, env
+            FACILITIES_COMPLETED = FACILITIES_SELECTED + 4,
+            ALLOCATIONS = FACILITIES_COMPLETED + 4,
+            ALLOCATED_BYTES,
+            JOURNALED_COMMANDS,
+            NUM_OF_COUNTERS
+        };
+        enum Timer {
+            PLAN_STEP,
+            SELECT_FACILITY,
+            BACKUP,
+            RESTORE,
+            OUTPUT,
+            JOURNAL_SYNC,
+            RECOVERY, //replaying the journal on start.
+            NUM_OF_TIMERS
+        };
+
+        static bool isCompiledIn();
+        static bool isEnabled();
+        static void setEnabled(bool enabled);
+        static void count(Counter counter, long long amount);
+        static void countPolicy(Counter counter, const SelectionPolicy& policy);
+        static void time(Timer timer, long long nanoseconds);
+        static void recordCommand(const BaseAction& action, long long nanoseconds);
+        static void reset();
+        static void print(std::ostream& out, const Simulation& simulation);
+
+        // Adds the lifetime of the scope to a timer.
+        class ScopedTimer {
+            public:
+                explicit ScopedTimer(Timer timer);
+                ~ScopedTimer();
+                ScopedTimer(const ScopedTimer& other) = delete;
+                ScopedTimer& operator= (const ScopedTimer& other) = delete;
+            private:
+                const Timer timer;
+                const bool timed; //statistics were enabled when the scope began.
+                const std::chrono::steady_clock::time_point begin;
+        };
+};
+
+#ifdef SPL_STATS
+#define SPL_STATS_JOIN2(a, b) a##b
+#define SPL_STATS_JOIN(a, b) SPL_STATS_JOIN2(a, b)
+#define SPL_STATS_TIMER(timer) Stats::ScopedTimer SPL_STATS_JOIN(statsTimer, __LINE__)(timer)
+#define SPL_STATS_COUNT_POLICY(counter, policy) Stats::countPolicy(counter, policy)
+#define SPL_STATS_COUNT(counter, amount) Stats::count(counter, amount)
+#else
+#define SPL_STATS_TIMER(timer)
+#define SPL_STATS_COUNT_POLICY(counter, policy)
+#define SPL_STATS_COUNT(counter, amount)
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "Simulation.h"
+using std::string;
+using std::vector;
+
+class BaseAction;
+
+// Final scores of one plan at the end of a variant.
+struct SweepRow {
+    int planId;
+    string settlementName;
+    string selectionPolicy;
+    int lifeQualityScore;
+    int economyScore;
+    int environmentScore;
+};
+
+struct SweepResult {
+    SweepResult(): rows(), errors(0) {}
+    vector<SweepRow> rows;
+    int errors; //actions of the variant that ended with ERROR.
+};
+
+/*
+Runs many variants of the same scenario side by side.
+
+The sweep file holds command lines in the REPL syntax. Lines before the first
+"variant <name>" line are applied once to the base simulation; every variant then
+runs its own lines on a copy of that base. The copies share the base facility
+catalog until a variant adds a facility of its own.
+*/
+class Sweep {
+    public:
+        Sweep(const string& configFilePath, const string& sweepFilePath);
+        void run(int numOfThreads, std::ostream& out) const;
+        int getNumOfVariants() const;
+        //rule of 5.
+        Sweep(const Sweep& other) = delete;
+        Sweep& operator= (const Sweep& other) = delete;
+        ~Sweep();
+
+    private:
+        Simulation base;
+        vector<string> variantNames;
+        vector<vector<BaseAction*>> variantActions;
+        SweepResult runVariant(int variantIndex) const;
+};
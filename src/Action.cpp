@@ -1,6 +1,13 @@
 #include "Action.h"
 #include "Simulation.h"
+#include "Stats.h"
+#include "Optimizer.h"
+#include "PlanTable.h"
 #include <iostream> // For cout, endl
+#include <algorithm>
+#include <thread>
+#include <fstream>
+#include <memory>
 using std::string;
 using std::cout;
 using std::endl;
@@ -28,10 +35,10 @@ void BaseAction:: complete() {
     this->status = ActionStatus:: COMPLETED;
 }
 
-void BaseAction:: error(string errorMsg) {
+void BaseAction:: error(string errorMsg, std::ostream& out) {
     this->status = ActionStatus:: ERROR;
     this-> errorMsg = errorMsg;
-    cout << "Error: " << getErrorMsg() << endl;
+    out << "Error: " << getErrorMsg() << endl;
 }
 
 const string& BaseAction:: getErrorMsg() const {
@@ -42,8 +49,10 @@ const string& BaseAction:: getErrorMsg() const {
 SimulateStep::SimulateStep(const int numOfSteps): numOfSteps(numOfSteps){}
 
 void SimulateStep::act(Simulation& simulation) {
-    for (int i = 0; i < numOfSteps; i++) {
-        simulation.step();
+    if (simulation.isLazySteps()) {
+        simulation.deferSteps(std::max(numOfSteps, 0));
+    }else {
+        simulation.step(numOfSteps);
     }
     complete();
     simulation.addAction(this);
@@ -60,10 +69,11 @@ AddPlan:: AddPlan(const string& settlementName, const string& selectionPolicy)
 : settlementName(settlementName), selectionPolicy(selectionPolicy){}
 
 void AddPlan:: act(Simulation& simulation) {
+    simulation.flushPendingSteps();
     SelectionPolicy* selectedPolicy = selectionPolicyFromString(selectionPolicy);
     if (!simulation.isSettlementExists(settlementName) || selectedPolicy == nullptr){
         delete selectedPolicy;
-        error("Cannot create this plan");
+        error("Cannot create this plan", simulation.getOutput());
     }else {
         Settlement& Settlement = simulation.getSettlement(settlementName);
         simulation.addPlan(Settlement, selectedPolicy);
@@ -88,7 +98,7 @@ void AddSettlement:: act(Simulation& simulation){
     if (simulation.addSettlement(new Settlement(settlementName,settlementType)))
         complete();
     else
-        error("Settlement already exists");
+        error("Settlement already exists", simulation.getOutput());
     simulation.addAction(this);
 }
  
@@ -105,10 +115,11 @@ AddFacility:: AddFacility(const string& facilityName, const FacilityCategory fac
 :facilityName(facilityName),facilityCategory(facilityCategory),price(price),lifeQualityScore(lifeQualityScore),economyScore(economyScore),environmentScore(environmentScore){}
 
 void AddFacility:: act(Simulation &simulation){
+    simulation.flushPendingSteps();
     if (simulation.addFacility(std::move(FacilityType(facilityName,facilityCategory,price,lifeQualityScore,economyScore,environmentScore))))
         complete();
     else {
-        error("Facility already exists");
+        error("Facility already exists", simulation.getOutput());
     }
     simulation.addAction(this);
 }
@@ -125,11 +136,12 @@ const string AddFacility:: toString() const {
 PrintPlanStatus:: PrintPlanStatus(int planId): planId(planId) {}
 
 void PrintPlanStatus:: act(Simulation &simulation) {
+    simulation.flushPendingSteps();
     if (simulation.isPlanExists(planId)){
-        simulation.getPlan(planId).printStatus();
+        simulation.getPlan(planId).printStatus(simulation.getOutput());
         complete();
     }else {
-        error("Plan does not exist");
+        error("Plan does not exist", simulation.getOutput());
     }
     simulation.addAction(this);
 }
@@ -146,8 +158,9 @@ const string PrintPlanStatus:: toString() const{
 ChangePlanPolicy:: ChangePlanPolicy(const int planId, const string& newPolicy): planId(planId), newPolicy(newPolicy) {}
 
 void ChangePlanPolicy:: act(Simulation& simulation) {
+    simulation.flushPendingSteps();
     if(!simulation.isPlanExists(planId)) {
-        error("Plan does not exist");
+        error("Plan does not exist", simulation.getOutput());
         simulation.addAction(this);
         return;
     }
@@ -156,11 +169,11 @@ void ChangePlanPolicy:: act(Simulation& simulation) {
     "\n" + "newPolicy: " + newPolicy;
 
     if (newPolicy != simulation.getPlan(planId).getSelectionPolicy()->toString()) {
-        simulation.getPlan(planId).setSelectionPolicy(selectionPolicyFromString(newPolicy));
+        simulation.setPlanPolicy(planId, selectionPolicyFromString(newPolicy));
         complete();
-        cout << outPut << endl;
+        simulation.getOutput() << outPut << endl;
     }else {
-        error("Cannot change selection policy");
+        error("Cannot change selection policy", simulation.getOutput());
     }
     simulation.addAction(this);
 }
@@ -175,8 +188,11 @@ const string ChangePlanPolicy:: toString() const {
 
 //PrintActionsLog.
 void PrintActionsLog:: act(Simulation& simulation){
-    for(BaseAction* action : simulation.GetActionsLog()){
-        cout << action->toString() << statusToString(action->getStatus()) << endl;
+    SPL_STATS_TIMER(Stats:: OUTPUT);
+    vector<string> lines;
+    simulation.readActionsLog(lines);
+    for(const string& line : lines){
+        simulation.getOutput() << line << endl;
     }
     simulation.addAction(this);
     complete();
@@ -205,11 +221,12 @@ const string Close::toString() const{
 
 //BackupSimulation.
 void BackupSimulation::act(Simulation& simulation){
-    if (backup != nullptr) {
-        delete backup;
+    simulation.flushPendingSteps();
+    if (simulation.saveBackup()) {
+        complete();
+    }else {
+        error("Backup exceeds the memory budget", simulation.getOutput());
     }
-    backup = new Simulation(simulation);
-    complete();
     simulation.addAction(this);
 }
 
@@ -223,10 +240,9 @@ const string BackupSimulation:: toString() const{
 
 //RestoreSimulation
 void RestoreSimulation:: act(Simulation& simulation){
-    if (backup == nullptr){
-       error("no Back up avilibale");
+    if (!simulation.restoreBackup()){
+       error("no Back up avilibale", simulation.getOutput());
     }else{
-        simulation = *backup;
         complete();
     }
     
@@ -240,3 +256,404 @@ RestoreSimulation* RestoreSimulation:: clone() const{
 const string RestoreSimulation::toString() const{
     return "restore";
 }
+
+//EndPlan.
+EndPlan:: EndPlan(int planId): planId(planId) {}
+
+void EndPlan:: act(Simulation& simulation){
+    simulation.flushPendingSteps();
+    if (simulation.endPlan(planId)) {
+        complete();
+    }else {
+        error("Plan does not exist", simulation.getOutput());
+    }
+    simulation.addAction(this);
+}
+
+EndPlan* EndPlan:: clone() const{
+    return new EndPlan(*this);
+}
+
+const string EndPlan:: toString() const{
+    return "endPlan " + std::to_string(planId);
+}
+
+//PrintTopPlans.
+PrintTopPlans:: PrintTopPlans(int numOfPlans, const string& scoreKind): numOfPlans(numOfPlans), scoreKind(scoreKind) {}
+
+void PrintTopPlans:: act(Simulation& simulation){
+    ScoreKind kind;
+    if (numOfPlans < 0 || !Leaderboard:: scoreKindFromString(scoreKind, kind)) {
+        error("Cannot rank plans", simulation.getOutput());
+    }else {
+        simulation.flushPendingSteps();
+        for (const std::pair<int, int>& entry: simulation.getLeaderboard().top(kind, numOfPlans)) {
+            simulation.getOutput() << "PlanID: " << entry.first << " SettlementName: " << simulation.getPlan(entry.first).getSettlement().getName()
+                << " Score: " << entry.second << endl;
+        }
+        complete();
+    }
+    simulation.addAction(this);
+}
+
+PrintTopPlans* PrintTopPlans:: clone() const{
+    return new PrintTopPlans(*this);
+}
+
+const string PrintTopPlans:: toString() const{
+    return "top " + std::to_string(numOfPlans) + " " + scoreKind;
+}
+
+//PrintAggregates.
+PrintAggregates:: PrintAggregates(const string& grouping): grouping(grouping) {}
+
+void PrintAggregates:: act(Simulation& simulation){
+    GroupBy groupBy;
+    if (grouping.compare(0, 3, "by=") != 0 || !Rollups:: groupByFromString(grouping.substr(3), groupBy)) {
+        error("Cannot group plans", simulation.getOutput());
+    }else {
+        simulation.flushPendingSteps();
+        for (const std::pair<const string, RollupGroup>& group: simulation.getRollups().getGroups(groupBy)) {
+            Rollups:: printGroup(simulation.getOutput(), group.first, group.second);
+        }
+        complete();
+    }
+    simulation.addAction(this);
+}
+
+PrintAggregates* PrintAggregates:: clone() const{
+    return new PrintAggregates(*this);
+}
+
+const string PrintAggregates:: toString() const{
+    return "agg " + grouping;
+}
+
+//PrintPlans.
+PrintPlans:: PrintPlans(const string& range, const string& fields, bool binary): range(range), fields(fields), binary(binary) {}
+
+void PrintPlans:: act(Simulation& simulation){
+    int first, last;
+    vector<PlanTable::Field> columns;
+    if (!PlanTable:: parseRange(range, first, last) || fields.compare(0, 7, "fields=") != 0 || !PlanTable:: parseFields(fields.substr(7), columns)) {
+        error("Cannot query plans", simulation.getOutput());
+    }else {
+        simulation.flushPendingSteps();
+        PlanTable table(columns);
+        table.gather(simulation.getPlans(), first, last);
+        if (binary) {
+            table.write(simulation.getOutput());
+        }else {
+            table.print(simulation.getOutput());
+        }
+        complete();
+    }
+    simulation.addAction(this);
+}
+
+PrintPlans* PrintPlans:: clone() const{
+    return new PrintPlans(*this);
+}
+
+const string PrintPlans:: toString() const{
+    return "plans " + range + " " + fields + (binary ? " binary" : "");
+}
+
+//WhatIf.
+WhatIf:: WhatIf(int planId, const string& policy, int numOfSteps): planId(planId), policy(policy), numOfSteps(numOfSteps) {}
+
+//helper function, the scores a fork of plan reaches after numOfSteps steps under selectionPolicy.
+static PlanScores projectPlan(const Plan& plan, SelectionPolicy* selectionPolicy, int numOfSteps) {
+    Plan fork(plan, selectionPolicy);
+    fork.advance(numOfSteps);
+    return PlanScores(fork);
+}
+
+//helper function.
+static string signedDifference(int value, int baseline) {
+    return (value >= baseline ? "+" : "") + std::to_string(value - baseline);
+}
+
+void WhatIf:: act(Simulation& simulation){
+    static const char* policies[] = {"nve", "bal", "eco", "env"};
+    simulation.flushPendingSteps();
+    vector<string> candidates;
+    for (const char* name: policies) {
+        if (policy == name || policy == "all") {
+            candidates.push_back(name);
+        }
+    }
+    if (!simulation.isPlanExists(planId)) {
+        error("Plan does not exist", simulation.getOutput());
+    }else if (candidates.empty() || numOfSteps < 0) {
+        error("Cannot project plan", simulation.getOutput());
+    }else {
+        // the plan is only read, so the baseline and every candidate are projected side by side.
+        const Plan& plan = simulation.getPlan(planId);
+        PlanScores baseline;
+        vector<PlanScores> projected(candidates.size());
+        vector<std::thread> workers;
+        workers.push_back(std::thread([&plan, &baseline, this]() {
+            baseline = projectPlan(plan, plan.getSelectionPolicy()->clone(), numOfSteps);
+        }));
+        for (size_t i = 0; i < candidates.size(); i++) {
+            // like changePolicy, a different policy starts fresh and the current one keeps its state.
+            SelectionPolicy* selectionPolicy = candidates[i] == plan.getSelectionPolicy()->toString() ?
+                plan.getSelectionPolicy()->clone() : selectionPolicyFromString(candidates[i]);
+            workers.push_back(std::thread([&plan, &projected, selectionPolicy, i, this]() {
+                projected[i] = projectPlan(plan, selectionPolicy, numOfSteps);
+            }));
+        }
+        for (std::thread& worker: workers) {
+            worker.join();
+        }
+
+        std::ostream& out = simulation.getOutput();
+        out << "Baseline: " << plan.getSelectionPolicy()->toString() << " LifeQualityScore: " << baseline.lifeQuality
+            << " EconomyScore: " << baseline.economy << " EnvironmentScore: " << baseline.environment << endl;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            out << "WhatIf: " << candidates[i]
+                << " LifeQualityScore: " << projected[i].lifeQuality << " (" << signedDifference(projected[i].lifeQuality, baseline.lifeQuality) << ")"
+                << " EconomyScore: " << projected[i].economy << " (" << signedDifference(projected[i].economy, baseline.economy) << ")"
+                << " EnvironmentScore: " << projected[i].environment << " (" << signedDifference(projected[i].environment, baseline.environment) << ")" << endl;
+        }
+        complete();
+    }
+    simulation.addAction(this);
+}
+
+WhatIf* WhatIf:: clone() const{
+    return new WhatIf(*this);
+}
+
+const string WhatIf:: toString() const{
+    return "whatif " + std::to_string(planId) + " " + policy + " " + std::to_string(numOfSteps);
+}
+
+//Optimize.
+Optimize:: Optimize(int planId, int horizon, const string& objective): planId(planId), horizon(horizon), objective(objective) {}
+
+void Optimize:: act(Simulation& simulation){
+    static const int beamWidth = 16;
+    simulation.flushPendingSteps();
+    Objective goal;
+    if (!simulation.isPlanExists(planId)) {
+        error("Plan does not exist", simulation.getOutput());
+    }else if (horizon < 0 || !Objective:: fromString(objective, goal)) {
+        error("Cannot optimize plan", simulation.getOutput());
+    }else {
+        PolicyOptimizer optimizer(simulation.getPlan(planId), horizon, goal, beamWidth);
+        OptimizerResult result = optimizer.run(std::max(1, (int)std::thread::hardware_concurrency()));
+        std::ostream& out = simulation.getOutput();
+        out << "Baseline: " << simulation.getPlan(planId).getSelectionPolicy()->toString() << " LifeQualityScore: " << result.baseline.lifeQuality
+            << " EconomyScore: " << result.baseline.economy << " EnvironmentScore: " << result.baseline.environment
+            << " Objective: " << result.baselineValue << endl;
+        out << "Schedule:";
+        for (size_t i = 0; i < result.schedule.size(); i++) {
+            out << (i == 0 ? " " : ", ") << "step " << result.schedule[i].step << " " << result.schedule[i].policy;
+        }
+        out << endl << "Optimized: LifeQualityScore: " << result.scores.lifeQuality << " EconomyScore: " << result.scores.economy
+            << " EnvironmentScore: " << result.scores.environment << " Objective: " << result.value << endl;
+        complete();
+    }
+    simulation.addAction(this);
+}
+
+Optimize* Optimize:: clone() const{
+    return new Optimize(*this);
+}
+
+const string Optimize:: toString() const{
+    return "optimize " + std::to_string(planId) + " " + std::to_string(horizon) + " " + objective;
+}
+
+//Subscribe.
+Subscribe:: Subscribe(const string& filePath): filePath(filePath) {}
+
+void Subscribe:: act(Simulation& simulation){
+    simulation.flushPendingSteps();
+    int subscriberId;
+    if (filePath == "") {
+        subscriberId = simulation.subscribe([](const vector<PlanEvent>& batch, std::ostream& output) {
+            for (const PlanEvent& event: batch) {
+                output << event << endl;
+            }
+        });
+    }else {
+        std::shared_ptr<std::ofstream> file = std::make_shared<std::ofstream>(filePath, std::ios::app);
+        if (!*file) {
+            error("Cannot open " + filePath, simulation.getOutput());
+            simulation.addAction(this);
+            return;
+        }
+        subscriberId = simulation.subscribe([file](const vector<PlanEvent>& batch, std::ostream&) {
+            for (const PlanEvent& event: batch) {
+                *file << event << '\n';
+            }
+            file->flush();
+        });
+    }
+    simulation.getOutput() << "SubscriberID: " << subscriberId << endl;
+    complete();
+    simulation.addAction(this);
+}
+
+Subscribe* Subscribe:: clone() const{
+    return new Subscribe(*this);
+}
+
+const string Subscribe:: toString() const{
+    return filePath == "" ? "subscribe" : "subscribe " + filePath;
+}
+
+//Unsubscribe.
+Unsubscribe:: Unsubscribe(int subscriberId): subscriberId(subscriberId) {}
+
+void Unsubscribe:: act(Simulation& simulation){
+    simulation.flushPendingSteps();
+    if (simulation.unsubscribe(subscriberId)) {
+        complete();
+    }else {
+        error("Subscriber does not exist", simulation.getOutput());
+    }
+    simulation.addAction(this);
+}
+
+Unsubscribe* Unsubscribe:: clone() const{
+    return new Unsubscribe(*this);
+}
+
+const string Unsubscribe:: toString() const{
+    return "unsubscribe " + std::to_string(subscriberId);
+}
+
+//Record.
+Record:: Record(const string& filePath, int interval, bool delta, const vector<int>& planIds): filePath(filePath), interval(interval), delta(delta), planIds(planIds) {}
+
+void Record:: act(Simulation& simulation){
+    simulation.flushPendingSteps();
+    if (interval <= 0 || std::any_of(planIds.begin(), planIds.end(), [](int planId) { return planId < 0; })) {
+        error("Cannot record plans", simulation.getOutput());
+    }else if (!simulation.startRecording(filePath, interval, delta, planIds)) {
+        error("Cannot open " + filePath, simulation.getOutput());
+    }else {
+        complete();
+    }
+    simulation.addAction(this);
+}
+
+Record* Record:: clone() const{
+    return new Record(*this);
+}
+
+const string Record:: toString() const{
+    string output = "record " + filePath + " " + std::to_string(interval);
+    if (delta) {
+        output += " delta";
+    }
+    for (int planId: planIds) {
+        output += " " + std::to_string(planId);
+    }
+    return output;
+}
+
+//StopRecording.
+StopRecording:: StopRecording() {}
+
+void StopRecording:: act(Simulation& simulation){
+    simulation.flushPendingSteps();
+    if (simulation.stopRecording()) {
+        complete();
+    }else {
+        error("Nothing is recorded", simulation.getOutput());
+    }
+    simulation.addAction(this);
+}
+
+StopRecording* StopRecording:: clone() const{
+    return new StopRecording(*this);
+}
+
+const string StopRecording:: toString() const{
+    return "record stop";
+}
+
+//PrintMemory.
+PrintMemory:: PrintMemory() {}
+
+void PrintMemory:: act(Simulation& simulation){
+    simulation.flushPendingSteps();
+    simulation.getMemoryUsage().print(simulation.getOutput());
+    if (simulation.getMemoryBudget() == 0) {
+        simulation.getOutput() << "Budget: none" << endl;
+    }else {
+        simulation.getOutput() << "Budget: " << simulation.getMemoryBudget() << endl;
+    }
+    complete();
+    simulation.addAction(this);
+}
+
+PrintMemory* PrintMemory:: clone() const{
+    return new PrintMemory(*this);
+}
+
+const string PrintMemory:: toString() const{
+    return "mem";
+}
+
+//SetMemoryBudget.
+SetMemoryBudget:: SetMemoryBudget(const string& budget): budget(budget) {}
+
+void SetMemoryBudget:: act(Simulation& simulation){
+    if (budget == "off") {
+        simulation.setMemoryBudget(0);
+        complete();
+    }else if (!budget.empty() && budget.size() < 20 && std::all_of(budget.begin(), budget.end(), ::isdigit) && std::stoull(budget) > 0) {
+        simulation.setMemoryBudget(std::stoull(budget));
+        complete();
+    }else {
+        error("Invalid memory budget", simulation.getOutput());
+    }
+    simulation.addAction(this);
+}
+
+SetMemoryBudget* SetMemoryBudget:: clone() const{
+    return new SetMemoryBudget(*this);
+}
+
+const string SetMemoryBudget:: toString() const{
+    return "mem budget " + budget;
+}
+
+//PrintStats.
+PrintStats:: PrintStats(const string& argument): argument(argument) {}
+
+void PrintStats:: act(Simulation& simulation){
+    if (!Stats:: isCompiledIn()) {
+        error("Statistics are not compiled in", simulation.getOutput());
+    }else if (argument == "") {
+        simulation.flushPendingSteps();
+        Stats:: print(simulation.getOutput(), simulation);
+        complete();
+    }else if (argument == "reset") {
+        // the steps deferred before the cut are counted before it.
+        simulation.flushPendingSteps();
+        Stats:: reset();
+        complete();
+    }else if (argument == "on" || argument == "off") {
+        simulation.flushPendingSteps();
+        Stats:: setEnabled(argument == "on");
+        complete();
+    }else {
+        error("Unknown stats argument", simulation.getOutput());
+    }
+    simulation.addAction(this);
+}
+
+PrintStats* PrintStats:: clone() const{
+    return new PrintStats(*this);
+}
+
+const string PrintStats:: toString() const{
+    return argument == "" ? "stats" : "stats " + argument;
+}
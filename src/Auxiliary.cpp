@@ -1,4 +1,8 @@
 #include "Auxiliary.h"
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <stdexcept>
 /*
 This is a 'static' method that receives a string(line) and returns a vector of the string's arguments.
 
@@ -17,4 +21,67 @@ std::vector<std::string> Auxiliary::parseArguments(const std::string& line) {
     }
 
     return arguments;
-}
\ No newline at end of file
+}
+
+/*
+Same split as above, but the arguments point into line instead of being copied.
+arguments is cleared and refilled, so a vector reused across lines stops allocating once it is large enough.
+*/
+void Auxiliary::parseArguments(const std::string& line, std::vector<ArgumentView>& arguments) {
+    arguments.clear();
+    const char* position = line.data();
+    const char* end = position + line.size();
+    while (position != end) {
+        while (position != end && std::isspace((unsigned char)*position)) {
+            position++;
+        }
+        const char* begin = position;
+        while (position != end && !std::isspace((unsigned char)*position)) {
+            position++;
+        }
+        if (position != begin) {
+            ArgumentView argument = {begin, (size_t)(position - begin)};
+            arguments.push_back(argument);
+        }
+    }
+}
+
+bool ArgumentView::operator== (const char* word) const {
+    return std::strlen(word) == length && std::memcmp(data, word, length) == 0;
+}
+
+bool ArgumentView::operator!= (const char* word) const {
+    return !(*this == word);
+}
+
+std::string ArgumentView::toString() const {
+    return std::string(data, length);
+}
+
+int ArgumentView::toInt() const {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (data[i] == '-' || data[i] == '+')) {
+        negative = data[i] == '-';
+        i++;
+    }
+    if (i == length || !std::isdigit((unsigned char)data[i])) {
+        throw std::invalid_argument("stoi");
+    }
+    long long value = 0;
+    for (; i < length && std::isdigit((unsigned char)data[i]); i++) {
+        value = value * 10 + (data[i] - '0');
+        if (value > (long long)INT_MAX + 1) {
+            throw std::out_of_range("stoi");
+        }
+    }
+    value = negative ? -value : value;
+    if (value > INT_MAX || value < INT_MIN) {
+        throw std::out_of_range("stoi");
+    }
+    return (int)value;
+}
+
+std::ostream& operator<< (std::ostream& out, const ArgumentView& argument) {
+    return out.write(argument.data, argument.length);
+}
@@ -0,0 +1,59 @@
+#include "CatalogFile.h"
+#include <fstream>
+#include <cstring>
+
+static const char catalogMagic[8] = {'S', 'P', 'L', 'C', 'A', 'T', '2', '\0'};
+
+bool CatalogFile:: compile(const vector<FacilityType>& facilities, const string& path) {
+    Header header;
+    std::memcpy(header.magic, catalogMagic, sizeof(catalogMagic));
+    header.numOfFacilities = facilities.size();
+    vector<Record> records;
+    string strings;
+    for (const FacilityType& facility: facilities) {
+        Record record = {(uint32_t)strings.size(), (uint32_t)facility.getName().size(), facility.getCost(),
+            facility.getLifeQualityScore(), facility.getEconomyScore(), facility.getEnvironmentScore(), (uint32_t)facility.getCategory()};
+        records.push_back(record);
+        strings += facility.getName();
+    }
+    header.stringTableSize = strings.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)records.data(), records.size() * sizeof(Record));
+    out.write(strings.data(), strings.size());
+    return (bool)out;
+}
+
+bool CatalogFile:: load(const string& path, vector<FacilityType>& facilities) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    string data(in.tellg(), '\0');
+    in.seekg(0);
+    if (data.size() < sizeof(Header) || !in.read(&data[0], data.size())) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data.data(), sizeof(Header));
+    size_t expected = sizeof(Header) + (size_t)header.numOfFacilities * sizeof(Record) + header.stringTableSize;
+    if (std::memcmp(header.magic, catalogMagic, sizeof(catalogMagic)) != 0 || expected != data.size()) {
+        return false;
+    }
+    const char* strings = data.data() + sizeof(Header) + (size_t)header.numOfFacilities * sizeof(Record);
+    vector<Record> records(header.numOfFacilities);
+    std::memcpy(records.data(), data.data() + sizeof(Header), records.size() * sizeof(Record));
+    for (const Record& record: records) {
+        if (record.category > 2 || (size_t)record.nameOffset + record.nameLength > header.stringTableSize) {
+            return false;
+        }
+    }
+    facilities.reserve(facilities.size() + records.size());
+    for (const Record& record: records) {
+        facilities.push_back(FacilityType(string(strings + record.nameOffset, record.nameLength), (FacilityCategory)record.category,
+            record.price, record.lifeQualityScore, record.economyScore, record.environmentScore));
+    }
+    return true;
+}
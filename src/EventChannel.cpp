@@ -0,0 +1,61 @@
+#include "EventChannel.h"
+#include <iostream>
+#include <algorithm>
+#include "MemoryUsage.h"
+
+std::ostream& operator<< (std::ostream& out, const PlanEvent& event) {
+    static const char* names[] = {"FacilityStarted", "FacilityOperational", "PlanStatus", "SelectionPolicy"};
+    return out << "Event: PlanID: " << event.planId << " " << names[(int)event.type] << ": " << event.detail;
+}
+
+EventChannel:: EventChannel(): subscribers(), nextSubscriberId(0), pending() {}
+
+int EventChannel:: subscribe(const Subscriber& subscriber) {
+    subscribers.push_back(std::make_pair(nextSubscriberId, subscriber));
+    return nextSubscriberId++;
+}
+
+bool EventChannel:: unsubscribe(int subscriberId) {
+    for (size_t i = 0; i < subscribers.size(); i++) {
+        if (subscribers[i].first == subscriberId) {
+            subscribers.erase(subscribers.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EventChannel:: hasSubscribers() const {
+    return !subscribers.empty();
+}
+
+void EventChannel:: raise(PlanEventType type, int planId, const string& detail) {
+    if (!subscribers.empty()) {
+        pending.push_back(PlanEvent(type, planId, detail));
+    }
+}
+
+void EventChannel:: flush(std::ostream& output) {
+    if (pending.empty()) {
+        return;
+    }
+    vector<PlanEvent> batch;
+    batch.swap(pending);
+    // a step command may advance the plans in several rounds, the events of each plan are kept together.
+    std::stable_sort(batch.begin(), batch.end(), [](const PlanEvent& first, const PlanEvent& second) {
+        return first.planId < second.planId;
+    });
+    // a subscriber may subscribe or unsubscribe while it handles the batch.
+    vector<std::pair<int, Subscriber>> current = subscribers;
+    for (const std::pair<int, Subscriber>& subscriber: current) {
+        subscriber.second(batch, output);
+    }
+}
+
+size_t EventChannel:: memoryUsage() const {
+    size_t bytes = MemoryUsage:: ofVector(subscribers) + MemoryUsage:: ofVector(pending);
+    for (const PlanEvent& event: pending) {
+        bytes += MemoryUsage:: ofString(event.detail);
+    }
+    return bytes;
+}
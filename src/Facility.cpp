@@ -59,6 +59,13 @@ void Facility:: step(){
     }
 }
 
+void Facility:: advance(int numOfSteps){
+    timeLeft = timeLeft > numOfSteps ? timeLeft - numOfSteps : 0;
+    if(timeLeft == 0) {
+        this->status = FacilityStatus::OPERATIONAL;
+    }
+}
+
 void Facility::setStatus(FacilityStatus status){
     this->status = status;
 }
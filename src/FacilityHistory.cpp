@@ -0,0 +1,67 @@
+#include "FacilityHistory.h"
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+std::shared_ptr<FacilityHistory> FacilityHistory:: open(const string& filePath) {
+    int fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return std::shared_ptr<FacilityHistory>(new FacilityHistory(fd));
+}
+
+FacilityHistory:: FacilityHistory(int fd): fd(fd), end(0) {}
+
+bool FacilityHistory::Position:: operator== (const Position& other) const {
+    return offset == other.offset && size == other.size;
+}
+
+bool FacilityHistory::Position:: operator!= (const Position& other) const {
+    return !(*this == other);
+}
+
+bool FacilityHistory:: append(Position& last, const string& facilityName) {
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.previous = last.offset;
+    header.previousSize = last.size;
+    header.nameLength = facilityName.size();
+    string record(sizeof(header) + facilityName.size(), '\0');
+    std::memcpy(&record[0], &header, sizeof(header));
+    std::memcpy(&record[sizeof(header)], facilityName.data(), facilityName.size());
+    // every writer reserves its own range first, so records never overlap.
+    int64_t offset = end.fetch_add(record.size());
+    if (pwrite(fd, record.data(), record.size(), offset) != (ssize_t)record.size()) {
+        return false;
+    }
+    last.offset = offset;
+    last.size = record.size();
+    return true;
+}
+
+void FacilityHistory:: read(const Position& last, vector<string>& facilityNames) const {
+    size_t first = facilityNames.size();
+    string record;
+    for (Position position = last; position.offset != none; ) {
+        record.resize(position.size);
+        if (position.size < sizeof(RecordHeader) || pread(fd, &record[0], record.size(), position.offset) != (ssize_t)record.size()) {
+            break;
+        }
+        RecordHeader header;
+        std::memcpy(&header, record.data(), sizeof(header));
+        facilityNames.push_back(record.substr(sizeof(header), header.nameLength));
+        position.offset = header.previous;
+        position.size = header.previousSize;
+    }
+    std::reverse(facilityNames.begin() + first, facilityNames.end());
+}
+
+int64_t FacilityHistory:: size() const {
+    return end.load();
+}
+
+FacilityHistory:: ~FacilityHistory() {
+    close(fd);
+}
@@ -0,0 +1,185 @@
+#include "Host.h"
+#include "Action.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+using std::cout;
+using std::endl;
+
+// a worker runs at most this many commands of one tenant before letting others in.
+static const int commandsPerTurn = 16;
+
+Tenant:: Tenant(const string& name, const string& configFilePath)
+: name(name), simulation(configFilePath), queueLock(), commands(), scheduled(false), closed(false) {}
+
+Host:: Host(const string& tenantsFilePath, int numOfWorkers)
+: tenants(), tenantsByName(), catalogs(), numOfWorkers(numOfWorkers < 1 ? 1 : numOfWorkers), readyLock(), readyChanged(),
+ready(), busyWorkers(0), stopping(false), outputLock() {
+    std::ifstream inputFile(tenantsFilePath);
+    string line;
+    while (std::getline(inputFile, line)) {
+        vector<string> parsed = Auxiliary:: parseArguments(line);
+        if (parsed.size() == 3 && parsed[0] == "tenant" && tenantsByName.count(parsed[1]) == 0) {
+            Tenant* tenant = new Tenant(parsed[1], parsed[2]);
+            shareCatalog(*tenant);
+            tenants.push_back(tenant);
+            tenantsByName[tenant->name] = tenant;
+        }
+    }
+    inputFile.close();
+}
+
+int Host:: getNumOfTenants() const {
+    return (int)tenants.size();
+}
+
+int Host:: getNumOfSharedCatalogs() const {
+    return (int)catalogs.size();
+}
+
+void Host:: shareCatalog(Tenant& tenant) {
+    for (const std::shared_ptr<vector<FacilityType>>& catalog: catalogs) {
+        if (tenant.simulation.shareCatalog(catalog)) {
+            return;
+        }
+    }
+    catalogs.push_back(tenant.simulation.getCatalog());
+}
+
+void Host:: start() {
+    cout << "The host has started with " << getNumOfTenants() << " tenants and " << getNumOfSharedCatalogs() << " catalogs" << endl;
+    vector<std::thread> workers;
+    for (int i = 0; i < numOfWorkers; i++) {
+        workers.push_back(std::thread(&Host::runWorker, this));
+    }
+
+    string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream stream(line);
+        string name;
+        if (!(stream >> name)) {
+            continue;
+        }
+        std::map<string, Tenant*>::iterator tenant = tenantsByName.find(name);
+        if (tenant == tenantsByName.end()) {
+            std::lock_guard<std::mutex> lock(outputLock);
+            cout << "Unknown tenant: " << name << endl;
+            continue;
+        }
+        string command;
+        std::getline(stream, command);
+        submit(*tenant->second, command);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(readyLock);
+        readyChanged.wait(lock, [this]() { return ready.empty() && busyWorkers == 0; });
+        stopping = true;
+    }
+    readyChanged.notify_all();
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+    cout << "The host has ended" << endl;
+}
+
+void Host:: submit(Tenant& tenant, const string& command) {
+    {
+        std::lock_guard<std::mutex> lock(tenant.queueLock);
+        tenant.commands.push_back(command);
+        if (tenant.scheduled) {
+            return;
+        }
+        tenant.scheduled = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(readyLock);
+        ready.push_back(&tenant);
+    }
+    readyChanged.notify_one();
+}
+
+void Host:: runWorker() {
+    while (true) {
+        Tenant* tenant;
+        {
+            std::unique_lock<std::mutex> lock(readyLock);
+            readyChanged.wait(lock, [this]() { return stopping || !ready.empty(); });
+            if (ready.empty()) {
+                return;
+            }
+            tenant = ready.front();
+            ready.pop_front();
+            busyWorkers++;
+        }
+        runCommands(*tenant);
+
+        bool requeue;
+        {
+            std::lock_guard<std::mutex> lock(tenant->queueLock);
+            requeue = !tenant->commands.empty();
+            tenant->scheduled = requeue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(readyLock);
+            if (requeue) {
+                ready.push_back(tenant);
+            }
+            busyWorkers--;
+        }
+        readyChanged.notify_all();
+    }
+}
+
+void Host:: runCommands(Tenant& tenant) {
+    vector<ArgumentView> command;
+    std::ostringstream output;
+    tenant.simulation.setOutput(output);
+    for (int i = 0; i < commandsPerTurn; i++) {
+        string line;
+        {
+            std::lock_guard<std::mutex> lock(tenant.queueLock);
+            if (tenant.commands.empty()) {
+                break;
+            }
+            line = tenant.commands.front();
+            tenant.commands.pop_front();
+        }
+        Auxiliary:: parseArguments(line, command);
+        if (command.empty()) {
+            continue;
+        }
+        output.str("");
+        if (tenant.closed) {
+            output << "Simulation is closed" << endl;
+        }else {
+            BaseAction* action = Simulation:: parseAction(command);
+            if (action == nullptr) {
+                output << "Unknown command: " << command[0] << endl;
+            }else {
+                action->act(tenant.simulation);
+                tenant.closed = command[0] == "close";
+            }
+        }
+        print(tenant, output.str());
+    }
+    tenant.simulation.setOutput(cout);
+}
+
+void Host:: print(const Tenant& tenant, const string& report) {
+    std::ostringstream prefixed;
+    std::istringstream lines(report);
+    string line;
+    while (std::getline(lines, line)) {
+        prefixed << tenant.name << ": " << line << "\n";
+    }
+    std::lock_guard<std::mutex> lock(outputLock);
+    cout << prefixed.str() << std::flush;
+}
+
+Host:: ~Host() {
+    for (Tenant* tenant: tenants) {
+        delete tenant;
+    }
+    tenants.clear();
+}
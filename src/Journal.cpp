@@ -0,0 +1,77 @@
+#include "Journal.h"
+#include "Stats.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+static const size_t maxPending = 1 << 20; //bytes kept in memory before they are written, they are synced at the next commit.
+
+Journal* Journal:: open(const string& filePath, vector<string>& commands) {
+    int fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    string contents;
+    char buffer[1 << 16];
+    ssize_t received;
+    while ((received = read(fd, buffer, sizeof(buffer))) > 0) {
+        contents.append(buffer, received);
+    }
+    // a crash while writing leaves part of a command, which was never acknowledged.
+    size_t end = contents.rfind('\n') + 1;
+    if (received < 0 || (end != contents.size() && ftruncate(fd, end) != 0)) {
+        close(fd);
+        return nullptr;
+    }
+    for (size_t begin = 0; begin < end; ) {
+        size_t newline = contents.find('\n', begin);
+        if (newline > begin) {
+            commands.push_back(contents.substr(begin, newline - begin));
+        }
+        begin = newline + 1;
+    }
+    return new Journal(fd);
+}
+
+Journal:: Journal(int fd): fd(fd), pending(), unsynced(false) {}
+
+void Journal:: append(const string& command) {
+    pending += command;
+    pending += '\n';
+    SPL_STATS_COUNT(Stats:: JOURNALED_COMMANDS, 1);
+    if (pending.size() >= maxPending) {
+        write();
+    }
+}
+
+bool Journal:: write() {
+    const char* data = pending.data();
+    size_t size = pending.size();
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+        unsynced = true;
+    }
+    pending.clear();
+    return true;
+}
+
+bool Journal:: commit() {
+    if (pending.empty() && !unsynced) {
+        return true;
+    }
+    if (!write()) {
+        return false;
+    }
+    SPL_STATS_TIMER(Stats:: JOURNAL_SYNC);
+    unsynced = false;
+    return fdatasync(fd) == 0;
+}
+
+Journal:: ~Journal() {
+    commit();
+    close(fd);
+}
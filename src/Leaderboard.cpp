@@ -0,0 +1,100 @@
+#include "Leaderboard.h"
+#include "Plan.h"
+#include "MemoryUsage.h"
+
+PlanScores:: PlanScores(const Plan& plan)
+: lifeQuality(plan.getlifeQualityScore()), economy(plan.getEconomyScore()), environment(plan.getEnvironmentScore()) {}
+
+int PlanScores:: get(ScoreKind kind) const {
+    if (kind == ScoreKind:: LIFE_QUALITY) {
+        return lifeQuality;
+    }
+    if (kind == ScoreKind:: ECONOMY) {
+        return economy;
+    }
+    if (kind == ScoreKind:: ENVIRONMENT) {
+        return environment;
+    }
+    return lifeQuality + economy + environment;
+}
+
+bool PlanScores:: operator== (const PlanScores& other) const {
+    return lifeQuality == other.lifeQuality && economy == other.economy && environment == other.environment;
+}
+
+bool PlanScores:: operator!= (const PlanScores& other) const {
+    return !(*this == other);
+}
+
+Leaderboard:: Leaderboard(): indexes() {}
+
+void Leaderboard:: insert(int planId, const PlanScores& scores) {
+    for (int kind = 0; kind < numOfKinds; kind++) {
+        indexes[kind].insert(std::make_pair(-scores.get((ScoreKind)kind), planId));
+    }
+}
+
+void Leaderboard:: update(int planId, const PlanScores& before, const PlanScores& after) {
+    for (int kind = 0; kind < numOfKinds; kind++) {
+        int oldScore = before.get((ScoreKind)kind);
+        int newScore = after.get((ScoreKind)kind);
+        if (oldScore != newScore) {
+            indexes[kind].erase(std::make_pair(-oldScore, planId));
+            indexes[kind].insert(std::make_pair(-newScore, planId));
+        }
+    }
+}
+
+void Leaderboard:: erase(int planId, const PlanScores& scores) {
+    for (int kind = 0; kind < numOfKinds; kind++) {
+        indexes[kind].erase(std::make_pair(-scores.get((ScoreKind)kind), planId));
+    }
+}
+
+vector<std::pair<int, int>> Leaderboard:: top(ScoreKind kind, int k) const {
+    vector<std::pair<int, int>> result;
+    for (const std::pair<int, int>& entry: indexes[(int)kind]) {
+        if ((int)result.size() >= k) {
+            break;
+        }
+        result.push_back(std::make_pair(entry.second, -entry.first));
+    }
+    return result;
+}
+
+void Leaderboard:: clear() {
+    for (std::set<std::pair<int, int>>& index: indexes) {
+        index.clear();
+    }
+}
+
+size_t Leaderboard:: memoryUsage() const {
+    size_t bytes = 0;
+    for (int kind = 0; kind < numOfKinds; kind++) {
+        bytes += MemoryUsage:: ofTreeNodes(indexes[kind].size(), sizeof(std::pair<int, int>));
+    }
+    return bytes;
+}
+
+bool Leaderboard:: scoreKindFromString(const string& name, ScoreKind& kind) {
+    for (int candidate = 0; candidate < numOfKinds; candidate++) {
+        if (name == scoreKindToString((ScoreKind)candidate)) {
+            kind = (ScoreKind)candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+string Leaderboard:: scoreKindToString(ScoreKind kind) {
+    if (kind == ScoreKind:: LIFE_QUALITY) {
+        return "lq";
+    }
+    if (kind == ScoreKind:: ECONOMY) {
+        return "eco";
+    }
+    if (kind == ScoreKind:: ENVIRONMENT) {
+        return "env";
+    }
+    return "total";
+}
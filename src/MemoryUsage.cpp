@@ -0,0 +1,74 @@
+#include "MemoryUsage.h"
+#include "SelectionPolicy.h"
+#include <iostream>
+using std::endl;
+
+MemoryUsage:: MemoryUsage()
+: catalog(0), plans(0), facilities(0), policies(0), settlements(0), actionsLog(0), indexes(0), events(0), recorder(0), backup(0) {}
+
+size_t MemoryUsage:: total() const {
+    return catalog + plans + facilities + policies + settlements + actionsLog + indexes + events + recorder + backup;
+}
+
+void MemoryUsage:: print(std::ostream& out) const {
+    out << "Catalog: " << catalog << endl;
+    out << "Plans: " << plans << endl;
+    out << "Facilities: " << facilities << endl;
+    out << "Policies: " << policies << endl;
+    out << "Settlements: " << settlements << endl;
+    out << "ActionsLog: " << actionsLog << endl;
+    out << "Indexes: " << indexes << endl;
+    out << "Events: " << events << endl;
+    out << "Recorder: " << recorder << endl;
+    out << "Backup: " << backup << endl;
+    out << "Total: " << total() << endl;
+}
+
+size_t MemoryUsage:: ofString(const string& text) {
+    // short strings live inside the string object itself.
+    return text.capacity() > string().capacity() ? text.capacity() + 1 : 0;
+}
+
+size_t MemoryUsage:: ofPolicy(const SelectionPolicy* policy) {
+    if (dynamic_cast<const BalancedSelection*>(policy) != nullptr) {
+        return sizeof(BalancedSelection);
+    }
+    return sizeof(NaiveSelection);
+}
+
+size_t MemoryUsage:: ofTreeNodes(size_t numOfNodes, size_t valueSize) {
+    // a red-black tree node holds three links and a color next to its value.
+    return numOfNodes * (4 * sizeof(void*) + valueSize);
+}
+
+ActionSpill* ActionSpill:: create() {
+    FILE* file = std::tmpfile();
+    return file == nullptr ? nullptr : new ActionSpill(file);
+}
+
+ActionSpill:: ActionSpill(FILE* file): file(file) {}
+
+std::pair<long, long> ActionSpill:: append(const string& lines) {
+    std::fseek(file, 0, SEEK_END);
+    long begin = std::ftell(file);
+    std::fwrite(lines.data(), 1, lines.size(), file);
+    std::fflush(file);
+    return std::make_pair(begin, begin + (long)lines.size());
+}
+
+void ActionSpill:: read(const std::pair<long, long>& range, vector<string>& lines) const {
+    string text(range.second - range.first, '\0');
+    std::fseek(file, range.first, SEEK_SET);
+    if (std::fread(&text[0], 1, text.size(), file) != text.size()) {
+        return;
+    }
+    size_t begin = 0;
+    for (size_t end = text.find('\n'); end != string::npos; end = text.find('\n', begin)) {
+        lines.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+}
+
+ActionSpill:: ~ActionSpill() {
+    std::fclose(file);
+}
@@ -0,0 +1,133 @@
+#include "Optimizer.h"
+#include "Plan.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <sstream>
+SelectionPolicy* selectionPolicyFromString(const string& selectionPolicy);
+
+static const char* policies[] = {"nve", "bal", "eco", "env"};
+
+Objective:: Objective(): lifeQualityWeight(1), economyWeight(1), environmentWeight(1), minimum(false) {}
+
+long long Objective:: evaluate(const PlanScores& scores) const {
+    if (minimum) {
+        return std::min({scores.lifeQuality, scores.economy, scores.environment});
+    }
+    return (long long)lifeQualityWeight * scores.lifeQuality + (long long)economyWeight * scores.economy +
+        (long long)environmentWeight * scores.environment;
+}
+
+bool Objective:: fromString(const string& name, Objective& objective) {
+    objective = Objective();
+    if (name == "lq" || name == "eco" || name == "env") {
+        objective.lifeQualityWeight = name == "lq";
+        objective.economyWeight = name == "eco";
+        objective.environmentWeight = name == "env";
+        return true;
+    }
+    if (name == "min") {
+        objective.minimum = true;
+        return true;
+    }
+    if (name == "total") {
+        return true;
+    }
+    char separator1, separator2;
+    std::istringstream weights(name.compare(0, 2, "w=") == 0 ? name.substr(2) : "");
+    weights >> objective.lifeQualityWeight >> separator1 >> objective.economyWeight >> separator2 >> objective.environmentWeight;
+    return !weights.fail() && weights.peek() == EOF && separator1 == ',' && separator2 == ',';
+}
+
+PolicyOptimizer:: PolicyOptimizer(const Plan& plan, int horizon, const Objective& objective, int beamWidth)
+: plan(plan), horizon(horizon), objective(objective), beamWidth(beamWidth), lock(), rollouts() {}
+
+PlanScores PolicyOptimizer:: rollOut(const Plan& plan, int time) {
+    string state = std::to_string(time) + " " + plan.stateToString();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::unordered_map<string, PlanScores>::const_iterator known = rollouts.find(state);
+        if (known != rollouts.end()) {
+            return known->second;
+        }
+    }
+    Plan fork(plan, plan.getSelectionPolicy()->clone());
+    fork.advance(horizon - time);
+    PlanScores scores(fork);
+    std::lock_guard<std::mutex> guard(lock);
+    rollouts[state] = scores;
+    return scores;
+}
+
+PolicyOptimizer::Node PolicyOptimizer:: expand(const Node& parent, const string& policy) {
+    Node child;
+    // like changePolicy, a different policy starts fresh and the current one keeps its state.
+    bool keeps = parent.plan->getSelectionPolicy()->toString() == policy;
+    child.plan = std::make_shared<Plan>(*parent.plan, keeps ? parent.plan->getSelectionPolicy()->clone() : selectionPolicyFromString(policy));
+    child.schedule = parent.schedule;
+    if (!keeps || child.schedule.empty()) {
+        ScheduleEntry entry = {parent.time, policy};
+        child.schedule.push_back(entry);
+    }
+    child.time = parent.time + child.plan->advanceToCompletion(horizon - parent.time);
+    child.rollout = rollOut(*child.plan, child.time);
+    child.value = objective.evaluate(child.rollout);
+    return child;
+}
+
+OptimizerResult PolicyOptimizer:: run(int numOfThreads) {
+    OptimizerResult result;
+    result.baseline = rollOut(plan, 0);
+    result.baselineValue = objective.evaluate(result.baseline);
+    result.scores = result.baseline;
+    result.value = result.baselineValue;
+    ScheduleEntry current = {0, plan.getSelectionPolicy()->toString()};
+    result.schedule.push_back(current);
+
+    Node root;
+    root.plan = std::make_shared<Plan>(plan, plan.getSelectionPolicy()->clone());
+    vector<Node> beam(1, root);
+    std::unordered_set<string> seen;
+    numOfThreads = std::max(numOfThreads, 1);
+    while (!beam.empty()) {
+        size_t numOfChildren = beam.size() * 4;
+        vector<Node> children(numOfChildren);
+        std::atomic<size_t> nextChild(0);
+        vector<std::thread> workers;
+        for (int i = 0; i < numOfThreads && i < (int)numOfChildren; i++) {
+            workers.push_back(std::thread([this, &beam, &children, &nextChild, numOfChildren]() {
+                for (size_t child = nextChild++; child < numOfChildren; child = nextChild++) {
+                    children[child] = expand(beam[child / 4], policies[child % 4]);
+                }
+            }));
+        }
+        for (std::thread& worker: workers) {
+            worker.join();
+        }
+
+        vector<Node> next;
+        for (Node& child: children) {
+            if (!seen.insert(std::to_string(child.time) + " " + child.plan->stateToString()).second) {
+                continue;
+            }
+            // ties keep the earlier schedule, which switches less and later.
+            if (child.value > result.value || (child.value == result.value && child.schedule.size() < result.schedule.size())) {
+                result.value = child.value;
+                result.scores = child.rollout;
+                result.schedule = child.schedule;
+            }
+            if (child.time < horizon) {
+                next.push_back(child);
+            }
+        }
+        std::stable_sort(next.begin(), next.end(), [](const Node& first, const Node& second) {
+            return first.value > second.value;
+        });
+        if ((int)next.size() > beamWidth) {
+            next.resize(beamWidth);
+        }
+        beam.swap(next);
+    }
+    return result;
+}
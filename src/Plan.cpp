@@ -1,34 +1,109 @@
 #include "Plan.h"
+#include "Stats.h"
+#include "MemoryUsage.h"
+#include <algorithm>
+#include <cstring>
+
+static const vector<Facility*> noFacilities;
+static const vector<int> noTwins;
+
+PlanState:: PlanState(int planId, SelectionPolicy* selectionPolicy): selectionPolicy(selectionPolicy), status(PlanStatus:: AVALIABLE), facilities(), underConstruction(), lastArchived(), numOfArchived(0), life_quality_score(0), economy_score(0), environment_score(0), twins(1, planId) {}
+
+PlanState:: PlanState(const PlanState& other): selectionPolicy(other.selectionPolicy->clone()), status(other.status), facilities(), underConstruction(), lastArchived(other.lastArchived), numOfArchived(other.numOfArchived), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score), twins(other.twins) {
+    for (Facility* item: other.facilities) {
+        facilities.push_back(new Facility(*item));
+    }
+    for (Facility* item: other.underConstruction) {
+        underConstruction.push_back(new Facility(*item));
+    }
+}
+
+PlanState:: ~PlanState() {
+    delete selectionPolicy;
+    for (Facility* facility : underConstruction) {
+        delete facility;
+    }
+    for (Facility* facility : facilities) {
+        delete facility;
+    }
+}
 
 Plan::Plan(const int planId, const Settlement& settlement, SelectionPolicy* selectionPolicy, const vector<FacilityType>& facilityOptions)
-: plan_id(planId), settlement(settlement), selectionPolicy(selectionPolicy),status(PlanStatus::AVALIABLE),facilities(),underConstruction(), facilityOptions(facilityOptions)
-,life_quality_score(0),economy_score(0), environment_score(0){}
+: plan_id(planId), settlement(settlement), facilityOptions(&facilityOptions), events(nullptr), history(nullptr), store(nullptr), state(std::make_shared<PlanState>(planId, selectionPolicy)) {}
+
+Plan::Resident:: Resident(Plan& plan): plan(plan), loaded(plan.state == nullptr) {
+    if (loaded) {
+        plan.state = plan.load();
+    }
+}
+
+Plan::Resident:: ~Resident() {
+    if (loaded) {
+        plan.save();
+    }
+}
 
 const int Plan:: getlifeQualityScore() const {
-    return life_quality_score;
+    return state != nullptr ? state->life_quality_score : record().lifeQualityScore;
 }
 
 const int Plan:: getEconomyScore() const {
-    return economy_score;
+    return state != nullptr ? state->economy_score : record().economyScore;
 }
 
 const int Plan:: getEnvironmentScore() const {
-    return environment_score;
+    return state != nullptr ? state->environment_score : record().environmentScore;
 }
 
 void Plan:: setSelectionPolicy(SelectionPolicy *selectionPolicy) {
-    if(this->selectionPolicy != nullptr){
-        delete this->selectionPolicy;
+    Resident resident(*this);
+    leaveTwins();
+    if(state->selectionPolicy != nullptr){
+        delete state->selectionPolicy;
     }
-    this->selectionPolicy = selectionPolicy;
+    state->selectionPolicy = selectionPolicy;
+    raise(PlanEventType:: POLICY_CHANGED, selectionPolicy->toString());
+}
+
+size_t Plan:: facilitiesMemoryUsage() const {
+    if (state == nullptr) {
+        return 0;
+    }
+    size_t bytes = MemoryUsage:: ofVector(state->facilities) + MemoryUsage:: ofVector(state->underConstruction);
+    for (const vector<Facility*>* list: {&state->facilities, &state->underConstruction}) {
+        for (const Facility* facility: *list) {
+            bytes += sizeof(Facility) + MemoryUsage:: ofString(facility->getName()) + MemoryUsage:: ofString(facility->getSettlementName());
+        }
+    }
+    return bytes;
+}
+
+void Plan:: compact() {
+    if (state == nullptr) {
+        return;
+    }
+    state->facilities.shrink_to_fit();
+    state->underConstruction.shrink_to_fit();
+    state->twins.shrink_to_fit();
 }
 
 void Plan::step(){
+    SPL_STATS_TIMER(Stats:: PLAN_STEP);
+    // a stored plan that only counts down is stepped in its record.
+    if (state == nullptr && idleSteps() > 0) {
+        skipIdleSteps(1);
+        return;
+    }
+    Resident resident(*this);
 
-    if (this->status == PlanStatus::AVALIABLE) {
+    vector<Facility*>& underConstruction = state->underConstruction;
+    if (state->status == PlanStatus::AVALIABLE) {
         while ((int)underConstruction.size() < this->settlement.getBuildCapacity()) {
-            Facility* selectedFacility = new Facility(selectionPolicy-> selectFacility(facilityOptions), settlement.getName());
+            SPL_STATS_TIMER(Stats:: SELECT_FACILITY);
+            Facility* selectedFacility = new Facility(state->selectionPolicy-> selectFacility(*facilityOptions), settlement.getName());
+            raise(PlanEventType:: FACILITY_STARTED, selectedFacility->getName());
             this->addFacility(selectedFacility);
+            SPL_STATS_COUNT_POLICY(Stats:: FACILITIES_SELECTED, *state->selectionPolicy);
         }
     }
     
@@ -36,118 +111,268 @@ void Plan::step(){
         underConstruction[i]->step();
         if (underConstruction[i]-> getStatus() == FacilityStatus:: OPERATIONAL) {
             Facility* facility = underConstruction[i];
-            facilities.push_back(facility);
-            life_quality_score += facility-> getLifeQualityScore();
-            economy_score += facility-> getEconomyScore();
-            environment_score += facility-> getEnvironmentScore();
+            SPL_STATS_COUNT_POLICY(Stats:: FACILITIES_COMPLETED, *state->selectionPolicy);
+            raise(PlanEventType:: FACILITY_OPERATIONAL, facility->getName());
+            state->life_quality_score += facility-> getLifeQualityScore();
+            state->economy_score += facility-> getEconomyScore();
+            state->environment_score += facility-> getEnvironmentScore();
+            archive(facility);
             underConstruction.erase(underConstruction.begin() + i);
             i--;
         }
     }
 
+    PlanStatus previousStatus = state->status;
     if ((int)underConstruction.size() < this->settlement.getBuildCapacity()) {
-        this-> status = PlanStatus:: AVALIABLE;
+        state-> status = PlanStatus:: AVALIABLE;
     }else {
-        this-> status = PlanStatus:: BUSY;
+        state-> status = PlanStatus:: BUSY;
+    }
+    if (state->status != previousStatus) {
+        raise(PlanEventType:: STATUS_CHANGED, statusToString());
     }
 }
 
-void Plan:: printStatus() const{
-    cout << this-> toString() << endl;
-    for (Facility* item: facilities) {
-        cout << item->toString() << endl;
+//helper method.
+void Plan::raise(PlanEventType type, const string& detail) const{
+    if (events == nullptr) {
+        return;
     }
-    for (Facility* item: underConstruction) {
-        cout << item->toString() << endl;
+    for (int planId: state->twins) {
+        events->raise(type, planId, detail);
     }
 }
 
+//helper method, the number of ticks in which nothing but counting down happens.
+int Plan::idleSteps() const{
+    if (state == nullptr) {
+        const PlanStore::Record& stored = record();
+        if ((PlanStatus)stored.status != PlanStatus::BUSY || stored.numOfUnderConstruction == 0) {
+            return 0;
+        }
+        int idleSteps = stored.timesLeft[0] - 1;
+        for (int i = 1; i < stored.numOfUnderConstruction; i++) {
+            idleSteps = std::min(idleSteps, stored.timesLeft[i] - 1);
+        }
+        return idleSteps;
+    }
+    const vector<Facility*>& underConstruction = state->underConstruction;
+    if (state->status != PlanStatus::BUSY || underConstruction.empty()) {
+        return 0;
+    }
+    // a busy plan selects nothing, so until the first facility completes a tick only counts down.
+    int idleSteps = underConstruction[0]->getTimeLeft() - 1;
+    for (Facility* facility: underConstruction) {
+        idleSteps = std::min(idleSteps, facility->getTimeLeft() - 1);
+    }
+    return idleSteps;
+}
+
+//helper method.
+void Plan::skipIdleSteps(int numOfSteps){
+    if (state == nullptr) {
+        PlanStore::Record& stored = store->at(plan_id);
+        for (int i = 0; i < stored.numOfUnderConstruction; i++) {
+            stored.timesLeft[i] -= numOfSteps;
+        }
+        return;
+    }
+    for (Facility* facility: state->underConstruction) {
+        facility->advance(numOfSteps);
+    }
+}
+
+void Plan::advance(int numOfSteps){
+    // a stored plan that only counts down stays in its record, see step.
+    if (state == nullptr && idleSteps() >= numOfSteps) {
+        skipIdleSteps(numOfSteps);
+        return;
+    }
+    Resident resident(*this);
+    while (numOfSteps > 0) {
+        int idleSteps = std::min(this->idleSteps(), numOfSteps);
+        if (idleSteps > 0) {
+            skipIdleSteps(idleSteps);
+            numOfSteps -= idleSteps;
+            continue;
+        }
+        step();
+        numOfSteps--;
+    }
+}
+
+int Plan::advanceToCompletion(int maxSteps){
+    Resident resident(*this);
+    size_t numOfCompleted = state->facilities.size() + state->numOfArchived;
+    int numOfSteps = 0;
+    while (numOfSteps < maxSteps && state->facilities.size() + state->numOfArchived == numOfCompleted) {
+        int idleSteps = std::min(this->idleSteps(), maxSteps - numOfSteps);
+        if (idleSteps > 0) {
+            skipIdleSteps(idleSteps);
+            numOfSteps += idleSteps;
+            continue;
+        }
+        step();
+        numOfSteps++;
+    }
+    return numOfSteps;
+}
+
+void Plan:: printStatus(std::ostream& out) const{
+    SPL_STATS_TIMER(Stats:: OUTPUT);
+    // a plan with thousands of facilities is one write and not a flush per line.
+    std::shared_ptr<const PlanState> current = view();
+    string text = this-> toString(*current) + "\n";
+    if (history != nullptr && current->numOfArchived > 0) {
+        vector<string> archived;
+        history->read(current->lastArchived, archived);
+        for (const string& name: archived) {
+            text += "FacilityName: " + name + "\nFacilityStatus: OPERATIONAL\n";
+        }
+    }
+    for (Facility* item: current->facilities) {
+        text += item->toString() + "\n";
+    }
+    for (Facility* item: current->underConstruction) {
+        text += item->toString() + "\n";
+    }
+    out << text << std::flush;
+}
+
 const vector<Facility*>& Plan:: getFacilities() const{
-    return facilities;
+    return state != nullptr ? state->facilities : noFacilities;
+}
+
+void Plan:: getBuildingNames(vector<string>& names) const{
+    if (state == nullptr) {
+        const PlanStore::Record& stored = record();
+        for (int i = 0; i < stored.numOfUnderConstruction; i++) {
+            names.push_back((*facilityOptions)[stored.facilityTypes[i]].getName());
+        }
+        return;
+    }
+    for (Facility* item: state->underConstruction) {
+        names.push_back(item->getName());
+    }
 }
 
+void Plan:: countUnderConstruction(int counts[3]) const{
+    if (state == nullptr) {
+        const PlanStore::Record& stored = record();
+        for (int i = 0; i < stored.numOfUnderConstruction; i++) {
+            counts[(int)(*facilityOptions)[stored.facilityTypes[i]].getCategory()]++;
+        }
+        return;
+    }
+    for (Facility* item: state->underConstruction) {
+        counts[(int)item->getCategory()]++;
+    }
+}
+
+void Plan:: getBuiltNames(vector<string>& names) const{
+    // a stored plan keeps no completed facilities in memory.
+    if (state == nullptr) {
+        const PlanStore::Record& stored = record();
+        if (history != nullptr && stored.numOfArchived > 0) {
+            FacilityHistory::Position last;
+            last.offset = stored.lastArchivedOffset;
+            last.size = stored.lastArchivedSize;
+            history->read(last, names);
+        }
+        return;
+    }
+    if (history != nullptr && state->numOfArchived > 0) {
+        history->read(state->lastArchived, names);
+    }
+    for (Facility* item: state->facilities) {
+        names.push_back(item->getName());
+    }
+}
 
 void Plan:: addFacility(Facility* facility){
-    if (status == PlanStatus:: AVALIABLE) {
-        underConstruction.push_back(facility);
+    Resident resident(*this);
+    if (state->status == PlanStatus:: AVALIABLE) {
+        state->underConstruction.push_back(facility);
     }else {
         delete facility;
     }
 }
 
 const string Plan:: toString() const{
+    return toString(*view());
+}
+
+//helper method.
+const string Plan:: toString(const PlanState& current) const{
     return "PlanID: " + std:: to_string(plan_id) +
     "\n" + "SettlementName: " + settlement.getName() +
     "\n" + "PlanStatus: " + statusToString() +
-    "\n" + "SelectionPolicy: " + selectionPolicy-> toString() +
-    "\n" + "LifeQualityScore: " + std:: to_string(life_quality_score) +
-    "\n" + "EconomyScore: " + std:: to_string(economy_score) +
-    "\n" + "EnvironmentScore: " + std:: to_string(environment_score);
+    "\n" + "SelectionPolicy: " + current.selectionPolicy-> toString() +
+    "\n" + "LifeQualityScore: " + std:: to_string(current.life_quality_score) +
+    "\n" + "EconomyScore: " + std:: to_string(current.economy_score) +
+    "\n" + "EnvironmentScore: " + std:: to_string(current.environment_score);
 }
 
 Plan::Plan(const Plan& other, const Settlement& settlement, const vector<FacilityType>& facilityOptions)
     : plan_id(other.plan_id),
       settlement(settlement),
-      selectionPolicy(other.selectionPolicy->clone()),
-      status(other.status),
-      facilities(),
-      underConstruction(),
-      facilityOptions(facilityOptions),
-      life_quality_score(other.life_quality_score),
-      economy_score(other.economy_score),
-      environment_score(other.environment_score)
-{
-    for (Facility* item : other.facilities) {
-        facilities.push_back(new Facility(*item));
-    }
-    for (Facility* item : other.underConstruction) {
-        underConstruction.push_back(new Facility(*item));
+      facilityOptions(&facilityOptions),
+      events(nullptr),
+      history(other.history),
+      store(nullptr),
+      state(std::make_shared<PlanState>(*other.view()))
+{}
+
+Plan::Plan(const Plan& other, const Settlement& settlement, const Plan& twin)
+    : plan_id(other.plan_id),
+      settlement(settlement),
+      facilityOptions(twin.facilityOptions),
+      events(nullptr),
+      history(other.history),
+      store(nullptr),
+      state(twin.state)
+{}
+
+Plan:: Plan(const Plan& other, SelectionPolicy* selectionPolicy): plan_id(other.plan_id), settlement(other.settlement), facilityOptions(other.facilityOptions), events(nullptr), history(nullptr), store(nullptr), state(std::make_shared<PlanState>(other.plan_id, selectionPolicy)) {
+    std::shared_ptr<const PlanState> source = other.view();
+    state->status = source->status;
+    state->life_quality_score = source->life_quality_score;
+    state->economy_score = source->economy_score;
+    state->environment_score = source->environment_score;
+    // completed facilities only matter through the scores, so a fork leaves them behind.
+    for (Facility* item: source->underConstruction) {
+        state->underConstruction.push_back(new Facility(*item));
     }
 }
 
 //rule of 5.
-Plan:: Plan(const Plan& other): plan_id(other.plan_id), settlement(other.settlement), selectionPolicy(other.selectionPolicy->clone()), status(other.status),facilities(),underConstruction(), facilityOptions(other.facilityOptions), life_quality_score(other.life_quality_score), economy_score(other.economy_score), environment_score(other.environment_score) {
-    for (Facility* item: other.facilities) {
-        this->facilities.push_back(new Facility(*item));
-    }
-    for (Facility* item: other.underConstruction) {
-        this->underConstruction.push_back(new Facility(*item));
-    }
+Plan:: Plan(const Plan& other): plan_id(other.plan_id), settlement(other.settlement), facilityOptions(other.facilityOptions), events(nullptr), history(other.history), store(nullptr), state(std::make_shared<PlanState>(*other.view())) {
+    state->twins.assign(1, plan_id);
 }
 
-Plan:: Plan(Plan&& other): plan_id(other.plan_id),
+Plan:: Plan(Plan&& other) noexcept: plan_id(other.plan_id),
     settlement(other.settlement),
-    selectionPolicy(std::move(other.selectionPolicy)),status(other.status),
-    facilities(std::move(other.facilities)),
-    underConstruction(std::move(other.underConstruction)),facilityOptions(other.facilityOptions),
-    life_quality_score(other.life_quality_score),
-    economy_score(other.economy_score),
-    environment_score(other.environment_score){
-        other.selectionPolicy = nullptr;
-    }
+    facilityOptions(other.facilityOptions), events(other.events),
+    history(other.history),
+    store(other.store),
+    state(std::move(other.state)){}
 
 
-Plan:: ~Plan() {
-    delete selectionPolicy;
-    for (Facility* facility : underConstruction) {
-        delete facility;
-    }
-    for (Facility* facility : facilities) {
-        delete facility;
-    }
-    underConstruction.clear();
-    facilities.clear();
-}
+Plan:: ~Plan() {}
 
 //helper method.
-const SelectionPolicy* Plan:: getSelectionPolicy() const{ 
-    return this->selectionPolicy;
+std::shared_ptr<const SelectionPolicy> Plan:: getSelectionPolicy() const{
+    if (state == nullptr) {
+        return std::shared_ptr<const SelectionPolicy>(SelectionPolicy:: fromRecord(record().policy));
+    }
+    return std::shared_ptr<const SelectionPolicy>(state, state->selectionPolicy);
 }
 //helper method.
 const Settlement& Plan::getSettlement() const{
     return settlement;
 }
 const string Plan::statusToString () const {
+    PlanStatus status = getStatus();
     if (status == PlanStatus:: AVALIABLE) {
         return "AVALIABLE";
     }
@@ -156,10 +381,176 @@ const string Plan::statusToString () const {
     }
     return "UNKNOWN";
 }
-void Plan::printplan() const{
-    cout << "PlanID: " + std:: to_string(plan_id) << endl;
-    cout << "SettlementName: " << settlement.getName() << endl;
-    cout << "LifeQualityScore: " << std:: to_string(life_quality_score) << endl;
-    cout << "EconomyScore: " << std:: to_string(economy_score) << endl;
-    cout << "EnvironmentScore: " << std:: to_string(environment_score) << endl;
+const string Plan::stateToString() const{
+    std::shared_ptr<const PlanState> current = view();
+    string key = statusToString() + " " + std::to_string(current->life_quality_score) + " " + std::to_string(current->economy_score) +
+        " " + std::to_string(current->environment_score) + " " + current->selectionPolicy->stateToString();
+    for (Facility* item: current->underConstruction) {
+        key += " " + item->getName() + " " + std::to_string(item->getTimeLeft());
+    }
+    return key;
+}
+void Plan::printplan(std::ostream& out) const{
+    SPL_STATS_TIMER(Stats:: OUTPUT);
+    string text;
+    appendReport(text);
+    out << text << std::flush;
+}
+
+void Plan:: appendReport(string& text) const{
+    text += "PlanID: " + std:: to_string(plan_id) + "\n";
+    text += "SettlementName: " + settlement.getName() + "\n";
+    text += "LifeQualityScore: " + std:: to_string(getlifeQualityScore()) + "\n";
+    text += "EconomyScore: " + std:: to_string(getEconomyScore()) + "\n";
+    text += "EnvironmentScore: " + std:: to_string(getEnvironmentScore()) + "\n";
+}
+//helper method.
+PlanStatus Plan::getStatus() const{
+    return state != nullptr ? state->status : (PlanStatus)record().status;
+}
+//helper method.
+int Plan::getPlanId() const{
+    return plan_id;
+}
+bool Plan::isTwinOf(const Plan& other) const{
+    if (state == nullptr || other.state == nullptr) {
+        return false;
+    }
+    if (settlement.getBuildCapacity() != other.settlement.getBuildCapacity() || state->lastArchived != other.state->lastArchived ||
+        state->facilities.size() != other.state->facilities.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < state->facilities.size(); i++) {
+        if (state->facilities[i]->getName() != other.state->facilities[i]->getName()) {
+            return false;
+        }
+    }
+    return stateToString() == other.stateToString();
+}
+void Plan::joinTwin(const Plan& twin){
+    state = twin.state;
+    vector<int>::iterator place = std::lower_bound(state->twins.begin(), state->twins.end(), plan_id);
+    if (place == state->twins.end() || *place != plan_id) {
+        state->twins.insert(place, plan_id);
+    }
+}
+void Plan::leaveTwins(){
+    if (!hasTwins()) {
+        return;
+    }
+    std::shared_ptr<PlanState> own = std::make_shared<PlanState>(*state);
+    own->twins.assign(1, plan_id);
+    state->twins.erase(std::find(state->twins.begin(), state->twins.end(), plan_id));
+    state = own;
+}
+void Plan::quitTwins(){
+    if (hasTwins()) {
+        state->twins.erase(std::lower_bound(state->twins.begin(), state->twins.end(), plan_id));
+    }
+}
+const vector<int>& Plan::getTwins() const{
+    return state != nullptr ? state->twins : noTwins;
+}
+bool Plan::hasTwins() const{
+    return state != nullptr && state->twins.size() > 1;
+}
+bool Plan::leadsTwins() const{
+    return state == nullptr || state->twins.front() == plan_id;
+}
+void Plan::setFacilityOptions(const vector<FacilityType>& facilityOptions){
+    this->facilityOptions = &facilityOptions;
+}
+void Plan::setEventChannel(EventChannel* events){
+    this->events = events;
+}
+void Plan::setHistory(FacilityHistory* history){
+    // a stored plan keeps no completed facilities in memory.
+    this->history = history;
+    if (state == nullptr) {
+        return;
+    }
+    vector<Facility*> completed;
+    completed.swap(state->facilities);
+    for (Facility* facility: completed) {
+        archive(facility);
+    }
+    save();
+}
+void Plan::setStore(PlanStore* store){
+    if (state == nullptr) {
+        state = load();
+    }
+    this->store = store;
+    save();
+}
+bool Plan::isStored() const{
+    return state == nullptr;
+}
+//helper method, keeps a completed facility in memory or moves it to the history.
+void Plan::archive(Facility* facility){
+    // once a facility could not be written the later ones stay in memory too, so they keep their order.
+    if (history == nullptr || !state->facilities.empty() || !history->append(state->lastArchived, facility->getName())) {
+        state->facilities.push_back(facility);
+        return;
+    }
+    state->numOfArchived++;
+    delete facility;
+}
+
+//helper method.
+std::shared_ptr<const PlanState> Plan::view() const{
+    if (state != nullptr) {
+        return state;
+    }
+    return load();
+}
+//helper method.
+std::shared_ptr<PlanState> Plan::load() const{
+    const PlanStore::Record& stored = record();
+    std::shared_ptr<PlanState> loaded = std::make_shared<PlanState>(plan_id, SelectionPolicy:: fromRecord(stored.policy));
+    loaded->status = (PlanStatus)stored.status;
+    loaded->life_quality_score = stored.lifeQualityScore;
+    loaded->economy_score = stored.economyScore;
+    loaded->environment_score = stored.environmentScore;
+    loaded->lastArchived.offset = stored.lastArchivedOffset;
+    loaded->lastArchived.size = stored.lastArchivedSize;
+    loaded->numOfArchived = stored.numOfArchived;
+    for (int i = 0; i < stored.numOfUnderConstruction; i++) {
+        Facility* facility = new Facility((*facilityOptions)[stored.facilityTypes[i]], settlement.getName());
+        facility->advance(facility->getCost() - stored.timesLeft[i]);
+        loaded->underConstruction.push_back(facility);
+    }
+    return loaded;
+}
+//helper method, twins and completed facilities kept in memory do not fit in a record.
+void Plan::save(){
+    if (store == nullptr || state == nullptr || state->twins.size() > 1 || !state->facilities.empty() ||
+        (int)state->underConstruction.size() > PlanStore::maxUnderConstruction || !store->reserve(plan_id)) {
+        return;
+    }
+    PlanStore::Record stored;
+    std::memset(&stored, 0, sizeof(stored));
+    stored.status = (int32_t)state->status;
+    stored.lifeQualityScore = state->life_quality_score;
+    stored.economyScore = state->economy_score;
+    stored.environmentScore = state->environment_score;
+    stored.lastArchivedOffset = state->lastArchived.offset;
+    stored.lastArchivedSize = state->lastArchived.size;
+    stored.numOfArchived = state->numOfArchived;
+    stored.policy = state->selectionPolicy->toRecord();
+    stored.numOfUnderConstruction = state->underConstruction.size();
+    for (int i = 0; i < stored.numOfUnderConstruction; i++) {
+        const Facility& facility = *state->underConstruction[i];
+        stored.facilityTypes[i] = store->facilityTypeOf(*facilityOptions, facility.getName());
+        stored.timesLeft[i] = facility.getTimeLeft();
+        if (stored.facilityTypes[i] < 0) {
+            return;
+        }
+    }
+    store->at(plan_id) = stored;
+    state.reset();
+}
+//helper method.
+const PlanStore::Record& Plan::record() const{
+    return store->at(plan_id);
 }
\ No newline at end of file
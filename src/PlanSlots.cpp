@@ -0,0 +1,158 @@
+#include "PlanSlots.h"
+
+PlanSlots:: PlanSlots(int stride): stride(stride), chunks(), slotsUsed(0), numOfPlans(0) {}
+
+Plan& PlanSlots:: add(Plan&& plan) {
+    size_t slot = slotOf(plan.getPlanId());
+    if (slot / chunkSize >= chunks.size()) {
+        chunks.resize(slot / chunkSize + 1);
+    }
+    std::unique_ptr<Chunk>& chunk = chunks[slot / chunkSize];
+    if (chunk == nullptr) {
+        chunk.reset(new Chunk());
+    }
+    Plan* added = new (&chunk->slots[slot % chunkSize]) Plan(std::move(plan));
+    chunk->live[slot % chunkSize] = true;
+    chunk->numOfLive++;
+    slotsUsed = slot + 1;
+    numOfPlans++;
+    return *added;
+}
+
+void PlanSlots:: erase(int planId) {
+    size_t slot = slotOf(planId);
+    std::unique_ptr<Chunk>& chunk = chunks[slot / chunkSize];
+    at(slot)->~Plan();
+    chunk->live[slot % chunkSize] = false;
+    numOfPlans--;
+    // the slots of ended plans are never used again.
+    if (--chunk->numOfLive == 0 && (slot / chunkSize + 1) * chunkSize <= slotsUsed) {
+        chunk.reset();
+    }
+}
+
+void PlanSlots:: clear() {
+    for (size_t slot = nextLive(0); slot < slotsUsed; slot = nextLive(slot + 1)) {
+        at(slot)->~Plan();
+    }
+    chunks.clear();
+    slotsUsed = 0;
+    numOfPlans = 0;
+}
+
+Plan* PlanSlots:: find(int planId) {
+    return planId < 0 ? nullptr : at(slotOf(planId));
+}
+
+const Plan* PlanSlots:: find(int planId) const {
+    return planId < 0 ? nullptr : at(slotOf(planId));
+}
+
+Plan* PlanSlots:: at(size_t slot) {
+    return const_cast<Plan*>(static_cast<const PlanSlots*>(this)->at(slot));
+}
+
+const Plan* PlanSlots:: at(size_t slot) const {
+    if (slot >= slotsUsed) {
+        return nullptr;
+    }
+    const std::unique_ptr<Chunk>& chunk = chunks[slot / chunkSize];
+    if (chunk == nullptr || !chunk->live[slot % chunkSize]) {
+        return nullptr;
+    }
+    return reinterpret_cast<const Plan*>(&chunk->slots[slot % chunkSize]);
+}
+
+size_t PlanSlots:: slotOf(int planId) const {
+    return planId / stride;
+}
+
+size_t PlanSlots:: numOfSlots() const {
+    return slotsUsed;
+}
+
+size_t PlanSlots:: size() const {
+    return numOfPlans;
+}
+
+bool PlanSlots:: empty() const {
+    return numOfPlans == 0;
+}
+
+size_t PlanSlots:: memoryUsage() const {
+    size_t bytes = chunks.capacity() * sizeof(std::unique_ptr<Chunk>);
+    for (const std::unique_ptr<Chunk>& chunk: chunks) {
+        if (chunk != nullptr) {
+            bytes += sizeof(Chunk);
+        }
+    }
+    return bytes;
+}
+
+void PlanSlots:: compact() {
+    chunks.shrink_to_fit();
+}
+
+PlanSlots::iterator PlanSlots:: begin() {
+    return iterator(this, 0);
+}
+
+PlanSlots::iterator PlanSlots:: end() {
+    return iterator(this, slotsUsed);
+}
+
+PlanSlots::const_iterator PlanSlots:: begin() const {
+    return const_iterator(this, 0);
+}
+
+PlanSlots::const_iterator PlanSlots:: end() const {
+    return const_iterator(this, slotsUsed);
+}
+
+PlanSlots::const_iterator PlanSlots:: lowerBound(int planId) const {
+    const_iterator plan(this, planId < 0 ? 0 : slotOf(planId));
+    // the slot also holds the IDs just below planId that belong to other shards.
+    if (plan != end() && plan->getPlanId() < planId) {
+        ++plan;
+    }
+    return plan;
+}
+
+//helper method.
+size_t PlanSlots:: nextLive(size_t slot) const {
+    while (slot < slotsUsed) {
+        const std::unique_ptr<Chunk>& chunk = chunks[slot / chunkSize];
+        if (chunk == nullptr) {
+            slot = (slot / chunkSize + 1) * chunkSize;
+            continue;
+        }
+        if (chunk->live[slot % chunkSize]) {
+            return slot;
+        }
+        slot++;
+    }
+    return slotsUsed;
+}
+
+//rule of 5.
+PlanSlots:: PlanSlots(PlanSlots&& other): stride(other.stride), chunks(std::move(other.chunks)), slotsUsed(other.slotsUsed), numOfPlans(other.numOfPlans) {
+    other.slotsUsed = 0;
+    other.numOfPlans = 0;
+}
+
+PlanSlots& PlanSlots:: operator= (PlanSlots&& other) {
+    if (this != &other) {
+        clear();
+        stride = other.stride;
+        chunks = std::move(other.chunks);
+        slotsUsed = other.slotsUsed;
+        numOfPlans = other.numOfPlans;
+        other.slotsUsed = 0;
+        other.numOfPlans = 0;
+    }
+    return *this;
+}
+
+PlanSlots:: ~PlanSlots() {
+    clear();
+}
@@ -0,0 +1,53 @@
+#include "PlanSnapshot.h"
+#include "PlanSlots.h"
+
+PlanSnapshot:: PlanSnapshot(const PlanSlots& plans, const Copy& copy, const Finish& finish)
+: plans(plans.numOfSlots(), nullptr), copy(copy), finish(finish), copies(plans.numOfSlots(), nullptr), states(new std::atomic<int>[plans.numOfSlots()]), helper() {
+    for (size_t i = 0; i < this->plans.size(); i++) {
+        this->plans[i] = plans.at(i);
+        states[i].store(NOT_COPIED);
+    }
+    helper = std::thread([this]() {
+        for (size_t i = this->plans.size(); i > 0; i--) {
+            copyOnce(i - 1);
+        }
+        // the simulation may still be copying the plan it claimed last.
+        for (size_t i = 0; i < this->plans.size(); i++) {
+            while (states[i].load() != COPIED) {
+                std::this_thread::yield();
+            }
+        }
+        this->finish(copies);
+    });
+}
+
+bool PlanSnapshot:: copyOnce(size_t slot) {
+    int expected = NOT_COPIED;
+    if (!states[slot].compare_exchange_strong(expected, COPYING)) {
+        return false;
+    }
+    if (plans[slot] != nullptr) {
+        copies[slot] = copy(*plans[slot]);
+    }
+    states[slot].store(COPIED);
+    return true;
+}
+
+void PlanSnapshot:: preserve(size_t slot) {
+    if (states[slot].load() == COPIED || copyOnce(slot)) {
+        return;
+    }
+    while (states[slot].load() != COPIED) {
+        std::this_thread::yield();
+    }
+}
+
+void PlanSnapshot:: wait() {
+    if (helper.joinable()) {
+        helper.join();
+    }
+}
+
+PlanSnapshot:: ~PlanSnapshot() {
+    wait();
+}
@@ -0,0 +1,78 @@
+#include "PlanStore.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static const size_t minCapacity = 4096;
+
+std::shared_ptr<PlanStore> PlanStore:: open(const string& filePath, int stride) {
+    int fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return std::shared_ptr<PlanStore>(new PlanStore(fd, filePath, stride));
+}
+
+std::shared_ptr<PlanStore> PlanStore:: emptyCopy() const {
+    string pattern = filePath + ".XXXXXX";
+    int fd = mkstemp(&pattern[0]);
+    if (fd < 0) {
+        return nullptr;
+    }
+    unlink(pattern.c_str());
+    return std::shared_ptr<PlanStore>(new PlanStore(fd, filePath, stride));
+}
+
+PlanStore:: PlanStore(int fd, const string& filePath, int stride)
+: fd(fd), filePath(filePath), stride(stride), records(nullptr), capacity(0), indexedCatalog(nullptr), numOfIndexed(0), facilityTypes() {}
+
+bool PlanStore:: reserve(int planId) {
+    size_t slot = planId / stride;
+    if (slot < capacity) {
+        return true;
+    }
+    size_t grown = std::max({slot + 1, 2 * capacity, minCapacity});
+    if (ftruncate(fd, grown * sizeof(Record)) != 0) {
+        return false;
+    }
+    void* mapping = records == nullptr ? mmap(nullptr, grown * sizeof(Record), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) :
+        mremap(records, capacity * sizeof(Record), grown * sizeof(Record), MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    // stepping reads the records in slot order.
+    madvise(mapping, grown * sizeof(Record), MADV_SEQUENTIAL);
+    records = (Record*)mapping;
+    capacity = grown;
+    return true;
+}
+
+PlanStore::Record& PlanStore:: at(int planId) {
+    return records[planId / stride];
+}
+
+const PlanStore::Record& PlanStore:: at(int planId) const {
+    return records[planId / stride];
+}
+
+int PlanStore:: facilityTypeOf(const vector<FacilityType>& catalog, const string& facilityName) {
+    // facilities are only ever appended to a catalog, so the index is rebuilt when it grows or is copied.
+    if (&catalog != indexedCatalog || catalog.size() != numOfIndexed) {
+        facilityTypes.clear();
+        for (size_t i = 0; i < catalog.size(); i++) {
+            facilityTypes.insert(std::make_pair(catalog[i].getName(), (int)i));
+        }
+        indexedCatalog = &catalog;
+        numOfIndexed = catalog.size();
+    }
+    std::unordered_map<string, int>::const_iterator type = facilityTypes.find(facilityName);
+    return type == facilityTypes.end() ? -1 : type->second;
+}
+
+PlanStore:: ~PlanStore() {
+    if (records != nullptr) {
+        munmap(records, capacity * sizeof(Record));
+    }
+    close(fd);
+}
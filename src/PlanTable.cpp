@@ -0,0 +1,203 @@
+#include "PlanTable.h"
+#include "PlanSlots.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+#include <sstream>
+
+static const char* fieldNames[] = {"id", "settlement", "policy", "status", "lq", "eco", "env", "building", "built"};
+
+//helper function, the facility names of a text column, "-" for none.
+static string joinNames(const vector<string>& names) {
+    if (names.empty()) {
+        return "-";
+    }
+    string joined = names[0];
+    for (size_t i = 1; i < names.size(); i++) {
+        joined += "," + names[i];
+    }
+    return joined;
+}
+
+//helper function, a plan ID of a range.
+static bool parseId(const string& text, int& id) {
+    if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+    id = std::stoi(text);
+    return true;
+}
+
+bool PlanTable:: parseFields(const string& names, vector<Field>& fields) {
+    fields.clear();
+    std::istringstream list(names);
+    string name;
+    while (std::getline(list, name, ',')) {
+        const char* const* found = std::find(std::begin(fieldNames), std::end(fieldNames), name);
+        if (found == std::end(fieldNames)) {
+            return false;
+        }
+        fields.push_back((Field)(found - std::begin(fieldNames)));
+    }
+    return !fields.empty();
+}
+
+bool PlanTable:: parseRange(const string& range, int& first, int& last) {
+    if (range == "all") {
+        first = 0;
+        last = INT_MAX;
+        return true;
+    }
+    size_t dash = range.find('-');
+    if (dash == string::npos) {
+        return parseId(range, first) && parseId(range, last);
+    }
+    return parseId(range.substr(0, dash), first) && parseId(range.substr(dash + 1), last) && first <= last;
+}
+
+bool PlanTable:: isNumber(Field field) {
+    return field == ID || field == LIFE_QUALITY || field == ECONOMY || field == ENVIRONMENT;
+}
+
+PlanTable:: PlanTable(const vector<Field>& fields): fields(fields), numOfRows(0), numbers(fields.size()), texts(fields.size()) {}
+
+void PlanTable:: gather(const PlanSlots& plans, int first, int last) {
+    PlanSlots::const_iterator plan = plans.lowerBound(first);
+    vector<string> names;
+    for (; plan != plans.end() && plan->getPlanId() <= last; ++plan) {
+        for (size_t i = 0; i < fields.size(); i++) {
+            switch (fields[i]) {
+                case ID: numbers[i].push_back(plan->getPlanId()); break;
+                case SETTLEMENT: texts[i].push_back(plan->getSettlement().getName()); break;
+                case POLICY: texts[i].push_back(plan->getSelectionPolicy()->toString()); break;
+                case STATUS: texts[i].push_back(plan->statusToString()); break;
+                case LIFE_QUALITY: numbers[i].push_back(plan->getlifeQualityScore()); break;
+                case ECONOMY: numbers[i].push_back(plan->getEconomyScore()); break;
+                case ENVIRONMENT: numbers[i].push_back(plan->getEnvironmentScore()); break;
+                case BUILDING:
+                    names.clear();
+                    plan->getBuildingNames(names);
+                    texts[i].push_back(joinNames(names));
+                    break;
+                case BUILT:
+                    names.clear();
+                    plan->getBuiltNames(names);
+                    texts[i].push_back(joinNames(names));
+                    break;
+            }
+        }
+        numOfRows++;
+    }
+}
+
+void PlanTable:: appendRow(const PlanTable& other, size_t row) {
+    for (size_t i = 0; i < fields.size(); i++) {
+        size_t column = std::find(other.fields.begin(), other.fields.end(), fields[i]) - other.fields.begin();
+        if (isNumber(fields[i])) {
+            numbers[i].push_back(other.numbers[column][row]);
+        }else {
+            texts[i].push_back(other.texts[column][row]);
+        }
+    }
+    numOfRows++;
+}
+
+void PlanTable:: print(std::ostream& out) const {
+    // the rows are formatted into one buffer, a million plans are one write and not a million flushes.
+    string text = fieldNames[fields[0]];
+    for (size_t i = 1; i < fields.size(); i++) {
+        text += ' ';
+        text += fieldNames[fields[i]];
+    }
+    text += '\n';
+    for (size_t row = 0; row < numOfRows; row++) {
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (i > 0) {
+                text += ' ';
+            }
+            text += isNumber(fields[i]) ? std::to_string(numbers[i][row]) : texts[i][row];
+        }
+        text += '\n';
+    }
+    out << text;
+}
+
+void PlanTable:: write(std::ostream& out) const {
+    string bytes;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (isNumber(fields[i])) {
+            for (int value: numbers[i]) {
+                int32_t number = value;
+                bytes.append((const char*)&number, sizeof(number));
+            }
+            continue;
+        }
+        for (const string& value: texts[i]) {
+            uint32_t length = value.size();
+            bytes.append((const char*)&length, sizeof(length));
+            bytes += value;
+        }
+    }
+    string names = fieldNames[fields[0]];
+    for (size_t i = 1; i < fields.size(); i++) {
+        names += ",";
+        names += fieldNames[fields[i]];
+    }
+    out << "Fields: " << names << " Plans: " << numOfRows << " Bytes: " << bytes.size() << "\n" << bytes;
+}
+
+bool PlanTable:: read(const string& report) {
+    std::istringstream header(report.substr(0, report.find('\n')));
+    string label, names;
+    size_t rows, size;
+    if (!(header >> label >> names) || label != "Fields:" || !(header >> label >> rows) || label != "Plans:" ||
+        !(header >> label >> size) || label != "Bytes:" || !parseFields(names, fields)) {
+        return false;
+    }
+    size_t offset = report.find('\n') + 1;
+    if (report.size() != offset + size) {
+        return false;
+    }
+    numOfRows = rows;
+    numbers.assign(fields.size(), vector<int>());
+    texts.assign(fields.size(), vector<string>());
+    for (size_t i = 0; i < fields.size(); i++) {
+        for (size_t row = 0; row < rows; row++) {
+            if (isNumber(fields[i])) {
+                int32_t number;
+                if (offset + sizeof(number) > report.size()) {
+                    return false;
+                }
+                std::memcpy(&number, &report[offset], sizeof(number));
+                numbers[i].push_back(number);
+                offset += sizeof(number);
+                continue;
+            }
+            uint32_t length;
+            if (offset + sizeof(length) > report.size()) {
+                return false;
+            }
+            std::memcpy(&length, &report[offset], sizeof(length));
+            offset += sizeof(length);
+            if (offset + length > report.size()) {
+                return false;
+            }
+            texts[i].push_back(report.substr(offset, length));
+            offset += length;
+        }
+    }
+    return offset == report.size();
+}
+
+const vector<PlanTable::Field>& PlanTable:: getFields() const {
+    return fields;
+}
+
+size_t PlanTable:: getNumOfRows() const {
+    return numOfRows;
+}
+
+int PlanTable:: getPlanId(size_t row) const {
+    return numbers[std::find(fields.begin(), fields.end(), ID) - fields.begin()][row];
+}
@@ -0,0 +1,114 @@
+#include "Recorder.h"
+#include "PlanSlots.h"
+#include "MemoryUsage.h"
+
+// rows are handed to the writer once the front buffer holds this many bytes.
+static const size_t bufferSize = 1 << 16;
+
+Recorder* Recorder:: open(const string& filePath, int interval, bool delta, const vector<int>& planIds) {
+    Recorder* recorder = new Recorder(interval, delta, planIds);
+    recorder->file.open(filePath, std::ios::trunc);
+    if (!recorder->file) {
+        delete recorder;
+        return nullptr;
+    }
+    recorder->front += delta ? "tick,planId,deltaLifeQuality,deltaEconomy,deltaEnvironment\n" : "tick,planId,lifeQuality,economy,environment\n";
+    return recorder;
+}
+
+Recorder:: Recorder(int interval, bool delta, const vector<int>& planIds)
+: file(), interval(interval), delta(delta), planIds(planIds.begin(), planIds.end()), previous(), front(), back(), backPending(false), stopping(false),
+  lock(), changed(), writer() {
+    front.reserve(bufferSize);
+    back.reserve(bufferSize);
+    writer = std::thread([this]() {
+        writeLoop();
+    });
+}
+
+int Recorder:: getInterval() const {
+    return interval;
+}
+
+void Recorder:: record(int tick, const PlanSlots& plans) {
+    string prefix = std::to_string(tick) + ",";
+    for (const Plan& plan: plans) {
+        if (!planIds.empty() && planIds.count(plan.getPlanId()) == 0) {
+            continue;
+        }
+        PlanScores row(plan);
+        if (delta) {
+            PlanScores& last = previous[plan.getPlanId()];
+            if (row == last) {
+                continue;
+            }
+            PlanScores change = row;
+            change.lifeQuality -= last.lifeQuality;
+            change.economy -= last.economy;
+            change.environment -= last.environment;
+            last = row;
+            row = change;
+        }
+        front += prefix;
+        front += std::to_string(plan.getPlanId());
+        front += ',';
+        front += std::to_string(row.lifeQuality);
+        front += ',';
+        front += std::to_string(row.economy);
+        front += ',';
+        front += std::to_string(row.environment);
+        front += '\n';
+    }
+    if (front.size() >= bufferSize) {
+        handOff();
+    }
+}
+
+size_t Recorder:: memoryUsage() const {
+    // a hash node holds its value and a link, next to one bucket pointer per bucket.
+    return front.capacity() + back.capacity() + previous.bucket_count() * sizeof(void*) +
+        previous.size() * (sizeof(std::pair<const int, PlanScores>) + sizeof(void*)) + planIds.size() * (sizeof(int) + 2 * sizeof(void*));
+}
+
+// swaps the front buffer with the back one once the writer is done with it.
+void Recorder:: handOff() {
+    std::unique_lock<std::mutex> guard(lock);
+    changed.wait(guard, [this]() {
+        return !backPending;
+    });
+    front.swap(back);
+    front.clear();
+    backPending = true;
+    changed.notify_all();
+}
+
+void Recorder:: writeLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [this]() {
+            return backPending || stopping;
+        });
+        if (!backPending) {
+            return;
+        }
+        // back is only touched by the writer until backPending is cleared.
+        guard.unlock();
+        file.write(back.data(), back.size());
+        file.flush();
+        guard.lock();
+        backPending = false;
+        changed.notify_all();
+    }
+}
+
+Recorder:: ~Recorder() {
+    if (!front.empty()) {
+        handOff();
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+        changed.notify_all();
+    }
+    writer.join();
+}
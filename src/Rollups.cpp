@@ -0,0 +1,147 @@
+#include "Rollups.h"
+#include "Plan.h"
+#include "MemoryUsage.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+static string settlementTypeToString(SettlementType type) {
+    if (type == SettlementType:: VILLAGE) {
+        return "Village";
+    }
+    if (type == SettlementType:: CITY) {
+        return "City";
+    }
+    return "Metropolis";
+}
+
+PlanSummary:: PlanSummary(): scores(), underConstruction() {}
+
+PlanSummary:: PlanSummary(const Plan& plan): scores(plan), underConstruction() {
+    plan.countUnderConstruction(underConstruction);
+}
+
+bool PlanSummary:: operator== (const PlanSummary& other) const {
+    return scores == other.scores && underConstruction[0] == other.underConstruction[0] &&
+        underConstruction[1] == other.underConstruction[1] && underConstruction[2] == other.underConstruction[2];
+}
+
+bool PlanSummary:: operator!= (const PlanSummary& other) const {
+    return !(*this == other);
+}
+
+RollupGroup:: RollupGroup(): numOfPlans(0), totals(), underConstruction() {}
+
+void RollupGroup:: add(const PlanSummary& summary, int sign) {
+    totals.lifeQuality += sign * summary.scores.lifeQuality;
+    totals.economy += sign * summary.scores.economy;
+    totals.environment += sign * summary.scores.environment;
+    for (int category = 0; category < 3; category++) {
+        underConstruction[category] += sign * summary.underConstruction[category];
+    }
+}
+
+void RollupGroup:: merge(const RollupGroup& other) {
+    numOfPlans += other.numOfPlans;
+    totals.lifeQuality += other.totals.lifeQuality;
+    totals.economy += other.totals.economy;
+    totals.environment += other.totals.environment;
+    for (int category = 0; category < 3; category++) {
+        underConstruction[category] += other.underConstruction[category];
+    }
+}
+
+Rollups:: Rollups(): byPolicy(), bySettlement(), byType() {}
+
+void Rollups:: add(std::map<string, RollupGroup>& groups, const string& name, const PlanSummary& summary, int sign) {
+    RollupGroup& group = groups[name];
+    group.numOfPlans += sign;
+    group.add(summary, sign);
+    if (group.numOfPlans == 0) {
+        groups.erase(name);
+    }
+}
+
+void Rollups:: insert(const Plan& plan) {
+    PlanSummary summary(plan);
+    add(byPolicy, plan.getSelectionPolicy()->toString(), summary, 1);
+    add(bySettlement, plan.getSettlement().getName(), summary, 1);
+    add(byType, settlementTypeToString(plan.getSettlement().getType()), summary, 1);
+}
+
+void Rollups:: erase(const Plan& plan) {
+    PlanSummary summary(plan);
+    add(byPolicy, plan.getSelectionPolicy()->toString(), summary, -1);
+    add(bySettlement, plan.getSettlement().getName(), summary, -1);
+    add(byType, settlementTypeToString(plan.getSettlement().getType()), summary, -1);
+}
+
+void Rollups:: update(const Plan& plan, const PlanSummary& before, const PlanSummary& after) {
+    std::map<string, RollupGroup>* all[] = {&byPolicy, &bySettlement, &byType};
+    const string names[] = {plan.getSelectionPolicy()->toString(), plan.getSettlement().getName(), settlementTypeToString(plan.getSettlement().getType())};
+    for (int i = 0; i < 3; i++) {
+        RollupGroup& group = (*all[i])[names[i]];
+        group.add(before, -1);
+        group.add(after, 1);
+    }
+}
+
+void Rollups:: changePolicy(const Plan& plan, const string& previousPolicy) {
+    PlanSummary summary(plan);
+    add(byPolicy, previousPolicy, summary, -1);
+    add(byPolicy, plan.getSelectionPolicy()->toString(), summary, 1);
+}
+
+const std::map<string, RollupGroup>& Rollups:: getGroups(GroupBy groupBy) const {
+    if (groupBy == GroupBy:: POLICY) {
+        return byPolicy;
+    }
+    if (groupBy == GroupBy:: SETTLEMENT) {
+        return bySettlement;
+    }
+    return byType;
+}
+
+size_t Rollups:: memoryUsage() const {
+    size_t bytes = 0;
+    for (const std::map<string, RollupGroup>* groups: {&byPolicy, &bySettlement, &byType}) {
+        bytes += MemoryUsage:: ofTreeNodes(groups->size(), sizeof(std::pair<const string, RollupGroup>));
+        for (const std::pair<const string, RollupGroup>& group: *groups) {
+            bytes += MemoryUsage:: ofString(group.first);
+        }
+    }
+    return bytes;
+}
+
+bool Rollups:: groupByFromString(const string& name, GroupBy& groupBy) {
+    if (name == "policy") {
+        groupBy = GroupBy:: POLICY;
+    }else if (name == "settlement") {
+        groupBy = GroupBy:: SETTLEMENT;
+    }else if (name == "type") {
+        groupBy = GroupBy:: SETTLEMENT_TYPE;
+    }else {
+        return false;
+    }
+    return true;
+}
+
+void Rollups:: printGroup(std::ostream& out, const string& name, const RollupGroup& group) {
+    out << "Group: " << name << " Plans: " << group.numOfPlans
+        << " LifeQualityScore: " << group.totals.lifeQuality << " EconomyScore: " << group.totals.economy
+        << " EnvironmentScore: " << group.totals.environment << std::fixed << std::setprecision(2)
+        << " AverageLifeQualityScore: " << (double)group.totals.lifeQuality / group.numOfPlans
+        << " AverageEconomyScore: " << (double)group.totals.economy / group.numOfPlans
+        << " AverageEnvironmentScore: " << (double)group.totals.environment / group.numOfPlans
+        << std::defaultfloat << " UnderConstruction: " << group.underConstruction[0] << " " << group.underConstruction[1]
+        << " " << group.underConstruction[2] << std::endl;
+}
+
+bool Rollups:: parseGroup(const string& line, string& name, RollupGroup& group) {
+    std::istringstream in(line);
+    string key, average;
+    in >> key >> name >> key >> group.numOfPlans >> key >> group.totals.lifeQuality >> key >> group.totals.economy
+        >> key >> group.totals.environment >> key >> average >> key >> average >> key >> average
+        >> key >> group.underConstruction[0] >> group.underConstruction[1] >> group.underConstruction[2];
+    return !in.fail();
+}
@@ -5,8 +5,20 @@
 using namespace std;
 const string statusToString(FacilityStatus status);//helper function
 
+SelectionPolicy* SelectionPolicy::fromRecord(const PolicyRecord& record){
+    switch (record.kind) {
+        case 0: return new NaiveSelection(record.state[0]);
+        case 1: return new BalancedSelection(record.state[0], record.state[1], record.state[2]);
+        case 2: return new EconomySelection(record.state[0]);
+        case 3: return new SustainabilitySelection(record.state[0]);
+    }
+    return nullptr;
+}
+
 NaiveSelection::NaiveSelection() : lastSelectedIndex(-1) {};
 
+NaiveSelection::NaiveSelection(int lastSelectedIndex) : lastSelectedIndex(lastSelectedIndex) {}
+
 const FacilityType& NaiveSelection::selectFacility(const vector<FacilityType>& facilitiesOptions){
     lastSelectedIndex = (lastSelectedIndex + 1) % facilitiesOptions.size();
     return facilitiesOptions[lastSelectedIndex];
@@ -16,6 +28,15 @@ const string NaiveSelection::toString() const{
     return "nve";
 }
 
+const string NaiveSelection::stateToString() const{
+    return toString() + " " + std::to_string(lastSelectedIndex);
+}
+
+PolicyRecord NaiveSelection::toRecord() const{
+    PolicyRecord record = {0, {lastSelectedIndex, 0, 0}};
+    return record;
+}
+
 NaiveSelection* NaiveSelection::clone() const{
     NaiveSelection* outPut = new NaiveSelection();
     outPut->lastSelectedIndex = lastSelectedIndex;
@@ -54,6 +75,15 @@ const string BalancedSelection::toString() const{
     return "bal";
 }
 
+const string BalancedSelection::stateToString() const{
+    return toString() + " " + std::to_string(LifeQualityScore) + " " + std::to_string(EconomyScore) + " " + std::to_string(EnvironmentScore);
+}
+
+PolicyRecord BalancedSelection::toRecord() const{
+    PolicyRecord record = {1, {LifeQualityScore, EconomyScore, EnvironmentScore}};
+    return record;
+}
+
 BalancedSelection *BalancedSelection::clone() const{
     return new BalancedSelection(LifeQualityScore, EconomyScore, EnvironmentScore);
 }
@@ -61,6 +91,8 @@ BalancedSelection *BalancedSelection::clone() const{
 
 EconomySelection::EconomySelection() : lastSelectedIndex(-1) {};
 
+EconomySelection::EconomySelection(int lastSelectedIndex) : lastSelectedIndex(lastSelectedIndex) {}
+
 const FacilityType& EconomySelection::selectFacility(const vector<FacilityType>& facilitiesOptions){
     while (true){
         lastSelectedIndex = (lastSelectedIndex + 1) % facilitiesOptions.size();
@@ -74,6 +106,15 @@ const string EconomySelection::toString() const{
     return "eco";
 }
 
+const string EconomySelection::stateToString() const{
+    return toString() + " " + std::to_string(lastSelectedIndex);
+}
+
+PolicyRecord EconomySelection::toRecord() const{
+    PolicyRecord record = {2, {lastSelectedIndex, 0, 0}};
+    return record;
+}
+
 EconomySelection* EconomySelection::clone() const{
     EconomySelection* outPut = new EconomySelection();
     outPut->lastSelectedIndex = lastSelectedIndex;
@@ -84,6 +125,8 @@ EconomySelection* EconomySelection::clone() const{
 
 SustainabilitySelection::SustainabilitySelection() : lastSelectedIndex(-1) {}
 
+SustainabilitySelection::SustainabilitySelection(int lastSelectedIndex) : lastSelectedIndex(lastSelectedIndex) {}
+
 const FacilityType& SustainabilitySelection::selectFacility(const vector<FacilityType>& facilitiesOptions){
     while (true){
         lastSelectedIndex = (lastSelectedIndex + 1) % facilitiesOptions.size();
@@ -97,6 +140,15 @@ const string SustainabilitySelection::toString() const{
     return "env";
 }
 
+const string SustainabilitySelection::stateToString() const{
+    return toString() + " " + std::to_string(lastSelectedIndex);
+}
+
+PolicyRecord SustainabilitySelection::toRecord() const{
+    PolicyRecord record = {3, {lastSelectedIndex, 0, 0}};
+    return record;
+}
+
 SustainabilitySelection* SustainabilitySelection::clone() const{
     SustainabilitySelection* outPut = new SustainabilitySelection();
     outPut->lastSelectedIndex = lastSelectedIndex;
@@ -0,0 +1,198 @@
+#include "Server.h"
+#include "Action.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+using std::cout;
+using std::endl;
+
+ServerSnapshot:: ServerSnapshot(const Simulation& simulation, long version): state(simulation), log(), version(version) {
+    // copies of actions start out COMPLETED, so the statuses are taken from the live log.
+    simulation.readActionsLog(log);
+}
+
+Server:: Server(const string& configFilePath, const string& socketPath)
+: socketPath(socketPath), simulation(configFilePath), writeLock(), snapshot(new ServerSnapshot(simulation, 0)),
+version(0), running(false), listenFd(-1), clientsLock(), clients() {}
+
+bool Server:: run() {
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socketPath.c_str());
+    if (listenFd < 0 || bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 64) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << endl;
+        return false;
+    }
+
+    running = true;
+    cout << "The simulation has started" << endl;
+    while (running) {
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            if (running && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        std::lock_guard<std::mutex> lock(clientsLock);
+        if (!running) {
+            close(clientFd);
+            break;
+        }
+        // a long-running server keeps a thread only for the clients still connected.
+        reapClients();
+        clients.push_back(ServerClient(clientFd));
+        clients.back().thread = std::thread(&Server::serveClient, this, &clients.back());
+    }
+
+    shutdown();
+    for (ServerClient& client: clients) {
+        client.thread.join();
+    }
+    clients.clear();
+    cout << "The simulation has ended" << endl;
+    return true;
+}
+
+void Server:: serveClient(ServerClient* client) {
+    converse(client->fd);
+    std::lock_guard<std::mutex> lock(clientsLock);
+    close(client->fd);
+    client->fd = -1;
+    client->finished = true;
+}
+
+//helper method, called with clientsLock held.
+void Server:: reapClients() {
+    for (std::list<ServerClient>::iterator client = clients.begin(); client != clients.end(); ) {
+        if (client->finished) {
+            client->thread.join();
+            client = clients.erase(client);
+        }else {
+            ++client;
+        }
+    }
+}
+
+//helper method.
+void Server:: converse(int clientFd) {
+    string pending;
+    char buffer[4096];
+    vector<ArgumentView> command;
+    long written = 0; //the version of the last command this client ran.
+    while (true) {
+        size_t newline;
+        while ((newline = pending.find('\n')) == string::npos) {
+            ssize_t received = read(clientFd, buffer, sizeof(buffer));
+            if (received <= 0) {
+                return;
+            }
+            pending.append(buffer, received);
+        }
+        string line = pending.substr(0, newline);
+        pending.erase(0, newline + 1);
+
+        Auxiliary:: parseArguments(line, command);
+        if (command.empty()) {
+            continue;
+        }
+        bool readOnly = (command[0] == "planStatus" && command.size() == 2) || command[0] == "log";
+        bool closes = command[0] == "close";
+        string response = (readOnly ? query(command, written) : execute(line, written)) + "\n";
+        for (size_t sent = 0; sent < response.size(); ) {
+            ssize_t numOfBytes = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (numOfBytes <= 0) {
+                return;
+            }
+            sent += numOfBytes;
+        }
+        if (closes) {
+            shutdown();
+            return;
+        }
+    }
+}
+
+string Server:: execute(const string& line, long& written) {
+    std::ostringstream output;
+    vector<ArgumentView> command;
+    Auxiliary:: parseArguments(line, command);
+    BaseAction* action = Simulation:: parseAction(command);
+    if (action == nullptr) {
+        output << "Unknown command: " << command[0] << endl;
+        return output.str();
+    }
+
+    std::lock_guard<std::mutex> lock(writeLock);
+    simulation.setOutput(output);
+    action->act(simulation);
+    simulation.setOutput(cout);
+    written = ++version;
+    return output.str();
+}
+
+string Server:: query(const vector<ArgumentView>& command, long written) {
+    std::shared_ptr<const ServerSnapshot> current = currentSnapshot(written);
+    std::ostringstream output;
+    if (command[0] == "log") {
+        for (const string& item: current->log) {
+            output << item << endl;
+        }
+    }else {
+        int planId = command[1].toInt();
+        if (current->state.isPlanExists(planId)) {
+            current->state.getPlan(planId).printStatus(output);
+        }else {
+            output << "Error: Plan does not exist" << endl;
+        }
+    }
+    return output.str();
+}
+
+// Waits for a copy that includes the client's own commands, otherwise refreshes the copy only when no command is running.
+std::shared_ptr<const ServerSnapshot> Server:: currentSnapshot(long written) {
+    std::shared_ptr<const ServerSnapshot> current = std::atomic_load(&snapshot);
+    if (current->version == version) {
+        return current;
+    }
+    std::unique_lock<std::mutex> lock(writeLock, std::defer_lock);
+    if (current->version < written) {
+        lock.lock();
+    }else if (!lock.try_lock()) {
+        return current;
+    }
+    // another query may have taken the copy while this one waited.
+    current = std::atomic_load(&snapshot);
+    if (current->version < version) {
+        current.reset(new ServerSnapshot(simulation, version));
+        std::atomic_store(&snapshot, current);
+    }
+    return current;
+}
+
+void Server:: shutdown() {
+    std::lock_guard<std::mutex> lock(clientsLock);
+    running = false;
+    if (listenFd >= 0) {
+        ::shutdown(listenFd, SHUT_RDWR);
+    }
+    for (const ServerClient& client: clients) {
+        if (client.fd >= 0) {
+            ::shutdown(client.fd, SHUT_RD);
+        }
+    }
+}
+
+Server:: ~Server() {
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
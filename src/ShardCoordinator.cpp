@@ -0,0 +1,438 @@
+#include "ShardCoordinator.h"
+#include "Simulation.h"
+#include "PlanTable.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/wait.h>
+using std::cout;
+using std::endl;
+string statusToString(ActionStatus status);
+
+// Pipe framing: every string travels as a 4-byte length followed by its bytes.
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+static bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t received = read(fd, data, size);
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+static bool writeFrame(int fd, const string& frame) {
+    uint32_t size = frame.size();
+    return writeAll(fd, (const char*)&size, sizeof(size)) && writeAll(fd, frame.data(), frame.size());
+}
+
+static bool readFrame(int fd, string& frame) {
+    uint32_t size;
+    if (!readAll(fd, (char*)&size, sizeof(size))) {
+        return false;
+    }
+    frame.resize(size);
+    return size == 0 || readAll(fd, &frame[0], size);
+}
+
+static bool writeReply(int fd, const ShardReply& reply) {
+    uint8_t status = (uint8_t)reply.status;
+    uint32_t numOfChunks = reply.chunks.size();
+    if (!writeAll(fd, (const char*)&status, sizeof(status)) || !writeAll(fd, (const char*)&numOfChunks, sizeof(numOfChunks))) {
+        return false;
+    }
+    for (const string& chunk: reply.chunks) {
+        if (!writeFrame(fd, chunk)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readReply(int fd, ShardReply& reply) {
+    uint8_t status;
+    uint32_t numOfChunks;
+    if (!readAll(fd, (char*)&status, sizeof(status)) || !readAll(fd, (char*)&numOfChunks, sizeof(numOfChunks))) {
+        return false;
+    }
+    reply.status = (ActionStatus)status;
+    reply.chunks.resize(numOfChunks);
+    for (string& chunk: reply.chunks) {
+        if (!readFrame(fd, chunk)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ShardCoordinator:: ShardCoordinator(const string& configFilePath, int numOfShards)
+: configFilePath(configFilePath), numOfShards(numOfShards < 1 ? 1 : numOfShards), workerPids(), toWorker(), fromWorker(),
+actionsLog(), backupLog(), hasBackup(false) {}
+
+void ShardCoordinator:: spawnWorkers() {
+    cout.flush();
+    for (int shard = 0; shard < numOfShards; shard++) {
+        int commands[2], replies[2];
+        if (pipe(commands) != 0 || pipe(replies) != 0) {
+            std::cerr << "Cannot create pipes for shard " << shard << endl;
+            std::exit(1);
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(commands[1]);
+            close(replies[0]);
+            for (size_t i = 0; i < toWorker.size(); i++) {
+                close(toWorker[i]);
+                close(fromWorker[i]);
+            }
+            runWorker(configFilePath, shard, numOfShards, commands[0], replies[1]);
+            _exit(0);
+        }
+        close(commands[0]);
+        close(replies[1]);
+        workerPids.push_back(pid);
+        toWorker.push_back(commands[1]);
+        fromWorker.push_back(replies[0]);
+    }
+}
+
+void ShardCoordinator:: stopWorkers() {
+    for (size_t i = 0; i < workerPids.size(); i++) {
+        close(toWorker[i]);
+        close(fromWorker[i]);
+        waitpid(workerPids[i], nullptr, 0);
+    }
+    workerPids.clear();
+    toWorker.clear();
+    fromWorker.clear();
+}
+
+void ShardCoordinator:: runWorker(const string& configFilePath, int shardIndex, int numOfShards, int in, int out) {
+    Simulation simulation(configFilePath, shardIndex, numOfShards);
+    std::ostringstream output;
+    simulation.setOutput(output);
+
+    string line;
+    vector<ArgumentView> command;
+    while (readFrame(in, line)) {
+        Auxiliary:: parseArguments(line, command);
+        ShardReply reply;
+        if (command[0] == "close") {
+            for (const Plan& plan: simulation.getPlans()) {
+                output.str("");
+                plan.printplan(output);
+                reply.chunks.push_back(output.str());
+            }
+            writeReply(out, reply);
+            break;
+        }
+        output.str("");
+        BaseAction* action = Simulation:: parseAction(command);
+        action->act(simulation);
+        reply.status = action->getStatus();
+        reply.chunks.push_back(output.str());
+        if (!writeReply(out, reply)) {
+            break;
+        }
+    }
+    close(in);
+    close(out);
+}
+
+// Actions with arguments are cloned from their arguments and come back COMPLETED, the others are copied with their status.
+ActionStatus ShardCoordinator:: clonedStatus(const std::pair<string, ActionStatus>& entry) {
+    static const char* rebuiltOnClone[] = {"step", "plan", "settlement", "facility", "planStatus", "changePolicy"};
+    string name = entry.first.substr(0, entry.first.find(' '));
+    for (const char* rebuilt: rebuiltOnClone) {
+        if (name == rebuilt) {
+            return ActionStatus:: COMPLETED;
+        }
+    }
+    return entry.second;
+}
+
+int ShardCoordinator:: ownerOf(int planId) const {
+    return ((planId % numOfShards) + numOfShards) % numOfShards;
+}
+
+vector<ShardReply> ShardCoordinator:: broadcast(const string& line) {
+    for (int shard = 0; shard < numOfShards; shard++) {
+        writeFrame(toWorker[shard], line);
+    }
+    // the workers run the command concurrently, replies are collected afterwards.
+    vector<ShardReply> replies(numOfShards);
+    for (int shard = 0; shard < numOfShards; shard++) {
+        if (!readReply(fromWorker[shard], replies[shard])) {
+            std::cerr << "Shard " << shard << " stopped responding" << endl;
+            std::exit(1);
+        }
+    }
+    return replies;
+}
+
+ShardReply ShardCoordinator:: route(int shard, const string& line) {
+    ShardReply reply;
+    if (!writeFrame(toWorker[shard], line) || !readReply(fromWorker[shard], reply)) {
+        std::cerr << "Shard " << shard << " stopped responding" << endl;
+        std::exit(1);
+    }
+    return reply;
+}
+
+void ShardCoordinator:: printMergedClose(const vector<ShardReply>& replies) const {
+    // every shard sends its reports in plan-ID order, ended plans leave gaps.
+    vector<std::pair<int, const string*>> reports;
+    for (const ShardReply& reply: replies) {
+        for (const string& chunk: reply.chunks) {
+            reports.push_back(std::make_pair(std::stoi(chunk.substr(chunk.find(' ') + 1)), &chunk));
+        }
+    }
+    std::sort(reports.begin(), reports.end());
+    for (const std::pair<int, const string*>& report: reports) {
+        cout << *report.second;
+    }
+}
+
+void ShardCoordinator:: printMergedTop(const vector<ShardReply>& replies, int numOfPlans) const {
+    if (replies[0].status == ActionStatus:: ERROR) {
+        cout << replies[0].chunks[0];
+        return;
+    }
+    // every shard sent its own best numOfPlans rows, the best overall are among them.
+    vector<std::pair<std::pair<int, int>, string>> rows; //((-score, planId), row)
+    for (const ShardReply& reply: replies) {
+        std::istringstream lines(reply.chunks[0]);
+        string row;
+        while (std::getline(lines, row)) {
+            int planId = std::stoi(row.substr(row.find(' ') + 1));
+            int score = std::stoi(row.substr(row.rfind(' ') + 1));
+            rows.push_back(std::make_pair(std::make_pair(-score, planId), row));
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    for (int i = 0; i < numOfPlans && i < (int)rows.size(); i++) {
+        cout << rows[i].second << endl;
+    }
+}
+
+void ShardCoordinator:: printMergedEvents(const vector<ShardReply>& replies) const {
+    // a step reports nothing but the events of subscribers, each shard lists them in plan order.
+    vector<std::pair<int, string>> events;
+    for (const ShardReply& reply: replies) {
+        std::istringstream lines(reply.chunks[0]);
+        string event;
+        while (std::getline(lines, event)) {
+            size_t planId = event.find("PlanID: ");
+            events.push_back(std::make_pair(planId == string::npos ? -1 : std::stoi(event.substr(planId + 8)), event));
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const std::pair<int, string>& first, const std::pair<int, string>& second) {
+        return first.first < second.first;
+    });
+    for (const std::pair<int, string>& event: events) {
+        cout << event.second << endl;
+    }
+}
+
+vector<ShardReply> ShardCoordinator:: broadcastPlans(const vector<ArgumentView>& command) {
+    vector<PlanTable::Field> fields;
+    string names = command[2].toString();
+    if (names.compare(0, 7, "fields=") != 0 || !PlanTable:: parseFields(names.substr(7), fields)) {
+        return broadcast("plans " + command[1].toString() + " " + names);
+    }
+    if (std::find(fields.begin(), fields.end(), PlanTable:: ID) == fields.end()) {
+        names += ",id";
+    }
+    return broadcast("plans " + command[1].toString() + " " + names + " binary");
+}
+
+void ShardCoordinator:: printMergedPlans(const vector<ShardReply>& replies, const vector<ArgumentView>& command) const {
+    if (replies[0].status == ActionStatus:: ERROR) {
+        cout << replies[0].chunks[0];
+        return;
+    }
+    // every shard sent its rows in plan-ID order, with the IDs even if they were not asked for.
+    vector<PlanTable> tables;
+    vector<std::pair<int, std::pair<size_t, size_t>>> rows; //(planId, (shard, row))
+    for (const ShardReply& reply: replies) {
+        tables.push_back(PlanTable(vector<PlanTable::Field>()));
+        if (!tables.back().read(reply.chunks[0])) {
+            std::cerr << "Shard " << tables.size() - 1 << " sent malformed plans" << endl;
+            return;
+        }
+        for (size_t row = 0; row < tables.back().getNumOfRows(); row++) {
+            rows.push_back(std::make_pair(tables.back().getPlanId(row), std::make_pair(tables.size() - 1, row)));
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    vector<PlanTable::Field> fields;
+    PlanTable:: parseFields(command[2].toString().substr(7), fields);
+    PlanTable merged(fields);
+    for (const std::pair<int, std::pair<size_t, size_t>>& row: rows) {
+        merged.appendRow(tables[row.second.first], row.second.second);
+    }
+    if (command.size() == 4 && command[3] == "binary") {
+        merged.write(cout);
+    }else {
+        merged.print(cout);
+    }
+}
+
+void ShardCoordinator:: printMergedMemory(const vector<ShardReply>& replies) const {
+    // every shard reports the same lines, the byte counts and budgets are summed.
+    vector<std::istringstream> reports;
+    for (const ShardReply& reply: replies) {
+        reports.emplace_back(reply.chunks[0]);
+    }
+    string line;
+    while (std::getline(reports[0], line)) {
+        size_t value = line.find(": ") + 2;
+        if (line.compare(value, string::npos, "none") == 0) {
+            for (size_t shard = 1; shard < reports.size(); shard++) {
+                std::getline(reports[shard], line);
+            }
+            cout << line << endl;
+            continue;
+        }
+        unsigned long long total = std::stoull(line.substr(value));
+        string other;
+        for (size_t shard = 1; shard < reports.size(); shard++) {
+            std::getline(reports[shard], other);
+            total += std::stoull(other.substr(other.find(": ") + 2));
+        }
+        cout << line.substr(0, value) << total << endl;
+    }
+}
+
+void ShardCoordinator:: printMergedAggregates(const vector<ShardReply>& replies) const {
+    if (replies[0].status == ActionStatus:: ERROR) {
+        cout << replies[0].chunks[0];
+        return;
+    }
+    std::map<string, RollupGroup> groups;
+    for (const ShardReply& reply: replies) {
+        std::istringstream lines(reply.chunks[0]);
+        string row, name;
+        while (std::getline(lines, row)) {
+            RollupGroup group;
+            if (Rollups:: parseGroup(row, name, group)) {
+                groups[name].merge(group);
+            }
+        }
+    }
+    for (const std::pair<const string, RollupGroup>& group: groups) {
+        Rollups:: printGroup(cout, group.first, group.second);
+    }
+}
+
+void ShardCoordinator:: start() {
+    spawnWorkers();
+    cout << "The simulation has started" << endl;
+
+    string line;
+    vector<ArgumentView> command;
+    while (getline(std::cin, line)) {
+        Auxiliary:: parseArguments(line, command);
+        if (command.empty()) {
+            continue;
+        }
+        BaseAction* action = Simulation:: parseAction(command);
+        if (action == nullptr) {
+            cout << "Unknown command: " << command[0] << endl;
+            continue;
+        }
+        string description = action->toString();
+        delete action;
+
+        if (command[0] == "log") {
+            for (const std::pair<string, ActionStatus>& item: actionsLog) {
+                cout << item.first << statusToString(item.second) << endl;
+            }
+            actionsLog.push_back(std::make_pair(description, ActionStatus:: COMPLETED));
+            continue;
+        }
+        if (command[0] == "close") {
+            printMergedClose(broadcast(line));
+            break;
+        }
+
+        ShardReply reply;
+        if (command[0] == "planStatus" || command[0] == "changePolicy" || command[0] == "whatif" ||
+            command[0] == "optimize" || command[0] == "endPlan") {
+            reply = route(ownerOf(command[1].toInt()), line);
+            cout << reply.chunks[0];
+        }else if (command[0] == "top") {
+            vector<ShardReply> replies = broadcast(line);
+            reply = replies[0];
+            printMergedTop(replies, command[1].toInt());
+        }else if (command[0] == "step") {
+            vector<ShardReply> replies = broadcast(line);
+            reply = replies[0];
+            printMergedEvents(replies);
+        }else if (command[0] == "mem" && command.size() == 1) {
+            vector<ShardReply> replies = broadcast(line);
+            reply = replies[0];
+            printMergedMemory(replies);
+        }else if (command[0] == "backup") {
+            // a shard refuses a backup that does not fit in its memory budget.
+            vector<ShardReply> replies = broadcast(line);
+            reply = replies[0];
+            for (const ShardReply& shardReply: replies) {
+                if (shardReply.status == ActionStatus:: ERROR) {
+                    reply = shardReply;
+                    break;
+                }
+            }
+            cout << reply.chunks[0];
+        }else if (command[0] == "plans") {
+            vector<ShardReply> replies = broadcastPlans(command);
+            reply = replies[0];
+            printMergedPlans(replies, command);
+        }else if (command[0] == "agg") {
+            vector<ShardReply> replies = broadcast(line);
+            reply = replies[0];
+            printMergedAggregates(replies);
+        }else {
+            reply = broadcast(line)[0];
+            cout << reply.chunks[0];
+        }
+
+        if (command[0] == "backup" && reply.status == ActionStatus:: COMPLETED) {
+            // like a Simulation copy, the saved log holds fresh clones of the actions.
+            backupLog = actionsLog;
+            for (std::pair<string, ActionStatus>& item: backupLog) {
+                item.second = clonedStatus(item);
+            }
+            hasBackup = true;
+        }
+        if (command[0] == "restore" && hasBackup) {
+            actionsLog = backupLog;
+            for (std::pair<string, ActionStatus>& item: actionsLog) {
+                item.second = clonedStatus(item);
+            }
+        }
+        actionsLog.push_back(std::make_pair(description, reply.status));
+    }
+    stopWorkers();
+    cout << "The simulation has ended" << endl;
+}
+
+ShardCoordinator:: ~ShardCoordinator() {
+    stopWorkers();
+}
@@ -1,9 +1,25 @@
 #include "Simulation.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include "Action.h"
+#include "SpscQueue.h"
+#include "Stats.h"
+#include "CatalogFile.h"
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
 
 // Helper functions.
+string statusToString(ActionStatus status);
+
 SelectionPolicy* selectionPolicyFromString(const string& selectionPolicy){
     if (selectionPolicy == "nve") {
         return new NaiveSelection();
@@ -23,10 +39,36 @@ const vector<BaseAction*>& Simulation:: GetActionsLog() const{
 
 //helper method.
 const bool Simulation:: isPlanExists(int planId) const {
-    return planId < (int)plans.size() && planId >= 0;
+    return planId < planCounter && planId >= 0 && planId % numOfShards == shardIndex && plans.find(planId) != nullptr;
 }
 
-Simulation:: Simulation(const string& configFilePath):isRunning(false), planCounter(0),actionsLog(),plans(),settlements(),facilitiesOptions(),unknownSettlement(new Settlement("ThereIsNon", SettlementType:: VILLAGE)), unknownPlan(new Plan(-1, *unknownSettlement, new EconomySelection, facilitiesOptions)) {
+//helper method.
+const PlanSlots& Simulation:: getPlans() const {
+    return plans;
+}
+
+//helper method.
+const Leaderboard& Simulation:: getLeaderboard() const {
+    return leaderboard;
+}
+
+//helper method.
+const Rollups& Simulation:: getRollups() const {
+    return rollups;
+}
+
+//helper method.
+std::ostream& Simulation:: getOutput() const {
+    return *output;
+}
+
+void Simulation:: setOutput(std::ostream& output) {
+    this->output = &output;
+}
+
+Simulation:: Simulation(const string& configFilePath): Simulation(configFilePath, 0, 1) {}
+
+Simulation:: Simulation(const string& configFilePath, int shardIndex, int numOfShards):isRunning(false), planCounter(0), shardIndex(shardIndex), numOfShards(numOfShards), lazySteps(false), backgroundBackups(false), pendingSteps(0), ticks(0),actionsLog(),actionSpill(),spilledActions(),numOfClonedSpills(0),memoryBudget(0),actionsSinceRelief(0),plans(numOfShards),twinCandidates(),leaderboard(),rollups(),settlements(),facilitiesOptions(new vector<FacilityType>()),history(),store(),unknownSettlement(new Settlement("ThereIsNon", SettlementType:: VILLAGE)), unknownPlan(new Plan(-1, *unknownSettlement, new EconomySelection, *facilitiesOptions)), output(&cout), backup(nullptr), backupInFlight(nullptr), events(nullptr), recorder(nullptr), journal(nullptr) {
     std::ifstream inputFile(configFilePath);   // Open the file for reading
 
     string line;
@@ -39,6 +81,20 @@ Simulation:: Simulation(const string& configFilePath):isRunning(false), planCoun
                 this-> addFacility(std::move(FacilityType(parsed[1], (FacilityCategory)std::stoi(parsed[2]), std::stoi(parsed[3]), std::stoi(parsed[4]), std::stoi(parsed[5]), std::stoi(parsed[6]))));
             }else if(parsed[0] == "plan" && parsed.size() == 3) {
                 this-> addPlan(getSettlement(parsed[1]), selectionPolicyFromString(parsed[2]));
+            }else if(parsed[0] == "history" && parsed.size() == 2) {
+                if (!this-> setHistoryFile(parsed[1])) {
+                    std::cerr << "Cannot create history file " << parsed[1] << endl;
+                }
+            }else if(parsed[0] == "store" && parsed.size() == 2) {
+                if (!this-> setStoreFile(parsed[1])) {
+                    std::cerr << "Cannot create store file " << parsed[1] << endl;
+                }
+            }else if(parsed[0] == "budget" && parsed.size() == 2) {
+                this-> setMemoryBudget(std::stoull(parsed[1]));
+            }else if(parsed[0] == "catalog" && parsed.size() == 2) {
+                if (!this-> loadCatalog(parsed[1])) {
+                    std::cerr << "Cannot load catalog " << parsed[1] << endl;
+                }
             }
         }   
     }
@@ -46,72 +102,246 @@ Simulation:: Simulation(const string& configFilePath):isRunning(false), planCoun
     inputFile.close();
 }
 
+// A parsed input line handed from the reader thread to the simulation thread.
+struct ParsedCommand {
+    ParsedCommand(): action(nullptr), closes(false), endOfInput(true), unknownName() {}
+    ParsedCommand(BaseAction* action, bool closes): action(action), closes(closes), endOfInput(false), unknownName() {}
+    ParsedCommand(const ParsedCommand& other) = default;
+    ParsedCommand& operator= (const ParsedCommand& other) = default;
+    BaseAction* action; //nullptr for unknown commands and for the end of input.
+    bool closes;
+    bool endOfInput;
+    string unknownName; //only set for unknown commands.
+};
+
 void Simulation:: start() {
     isRunning = true;
     cout << "The simulation has started" << endl;
 
-    while (isRunning) {
+    // The reader thread reads and parses ahead while the simulation thread executes,
+    // it stops after "close" so it never blocks on input that will not be used.
+    SpscQueue<ParsedCommand> commands(1024);
+    std::thread reader([&commands]() {
         string line;
-        getline(std::cin, line);
-
-        vector<std::string> command = Auxiliary:: parseArguments(line);
-        if (command.empty()) {
-            continue;
+        vector<ArgumentView> command;
+        while (getline(std::cin, line)) {
+            Auxiliary:: parseArguments(line, command);
+            if (command.empty()) {
+                continue;
+            }
+            ParsedCommand parsed(parseAction(command), command[0] == "close");
+            if (parsed.action == nullptr) {
+                parsed.unknownName = command[0].toString();
+            }
+            commands.push(parsed);
+            if (parsed.closes) {
+                return;
+            }
         }
-        BaseAction* action = nullptr;
+        commands.push(ParsedCommand());
+    });
 
-        if (command[0] == "step" && command.size() == 2) {
-            int numOfSteps = std::stoi(command[1]);
-            action = new SimulateStep(numOfSteps);
+    // what journaled commands print is held until their group is durable, so nothing shown is lost in a crash.
+    static const std::streamoff maxHeld = 1 << 20;
+    std::ostream* shown = output;
+    std::ostringstream held;
+    while (isRunning) {
+        // a group of journaled commands becomes durable before the simulation waits for input or shows state.
+        if (commands.empty() || held.tellp() >= maxHeld) {
+            commitJournal(held, *shown);
         }
-        if (command[0] == "plan" && command.size() == 3) {
-            action = new AddPlan(command[1], command[2]);
+        ParsedCommand command = commands.pop();
+        if (command.endOfInput) {
+            break;
         }
-        if (command[0] == "settlement" && command.size() == 3) {
-            SettlementType type = (SettlementType)(std::stoi(command[2]));
-            action = new AddSettlement(command[1], type);
+        if (command.closes) {
+            isRunning = false;
         }
-        if (command[0] == "facility" && command.size() == 7) {
-            action = new AddFacility(command[1], (FacilityCategory)(std::stoi(command[2])), std::stoi(command[3]), std::stoi(command[4]), std::stoi(command[5]), std::stoi(command[6]));
+
+        if (journal != nullptr) {
+            if (command.action != nullptr && isJournaled(*command.action)) {
+                journal->append(command.action->toString());
+                output = &held;
+            }else {
+                commitJournal(held, *shown);
+                output = shown;
+            }
         }
-        if (command[0] == "planStatus" && command.size() == 2) {
-            int planId = std::stoi(command[1]);
-            action = new PrintPlanStatus(planId);
+        if (command.action != nullptr) {
+#ifdef SPL_STATS
+            if (Stats:: isEnabled()) {
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                command.action->act(*this);
+                Stats:: recordCommand(*command.action, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+            }else {
+                command.action->act(*this);
+            }
+#else
+            command.action->act(*this);
+#endif
+        }else {
+            cout << "Unknown command: " << command.unknownName << endl;
         }
-        if (command[0] == "changePolicy" && command.size() == 3) {
-            int planId = std::stoi(command[1]);
-            action = new ChangePlanPolicy(planId, command[2]);
+    }
+    reader.join();
+    commitJournal(held, *shown);
+    output = shown;
+    cout << "The simulation has ended" << endl;
+}
+
+// One REPL command: its name, the number of arguments it takes (counting the name, -1 for any) and its factory.
+struct CommandEntry {
+    const char* name;
+    int numOfArguments;
+    BaseAction* (*factory)(const vector<ArgumentView>& command);
+};
+
+static const CommandEntry commandTable[] = {
+    {"step", 2, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new SimulateStep(command[1].toInt());
+    }},
+    {"plan", 3, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new AddPlan(command[1].toString(), command[2].toString());
+    }},
+    {"settlement", 3, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new AddSettlement(command[1].toString(), (SettlementType)(command[2].toInt()));
+    }},
+    {"facility", 7, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new AddFacility(command[1].toString(), (FacilityCategory)(command[2].toInt()), command[3].toInt(), command[4].toInt(), command[5].toInt(), command[6].toInt());
+    }},
+    {"planStatus", 2, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new PrintPlanStatus(command[1].toInt());
+    }},
+    {"changePolicy", 3, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new ChangePlanPolicy(command[1].toInt(), command[2].toString());
+    }},
+    {"endPlan", 2, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new EndPlan(command[1].toInt());
+    }},
+    {"log", -1, [](const vector<ArgumentView>&) -> BaseAction* {
+        return new PrintActionsLog();
+    }},
+    {"backup", -1, [](const vector<ArgumentView>&) -> BaseAction* {
+        return new BackupSimulation();
+    }},
+    {"restore", -1, [](const vector<ArgumentView>&) -> BaseAction* {
+        return new RestoreSimulation();
+    }},
+    {"close", -1, [](const vector<ArgumentView>&) -> BaseAction* {
+        return new Close();
+    }},
+    {"top", 3, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new PrintTopPlans(command[1].toInt(), command[2].toString());
+    }},
+    {"agg", 2, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new PrintAggregates(command[1].toString());
+    }},
+    {"plans", -1, [](const vector<ArgumentView>& command) -> BaseAction* {
+        if (command.size() == 3 || (command.size() == 4 && command[3] == "text")) {
+            return new PrintPlans(command[1].toString(), command[2].toString(), false);
         }
-        if (command[0] == "log") {
-            action = new PrintActionsLog();
+        return command.size() == 4 && command[3] == "binary" ? new PrintPlans(command[1].toString(), command[2].toString(), true) : nullptr;
+    }},
+    {"whatif", 4, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new WhatIf(command[1].toInt(), command[2].toString(), command[3].toInt());
+    }},
+    {"optimize", 4, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new Optimize(command[1].toInt(), command[2].toInt(), command[3].toString());
+    }},
+    {"subscribe", -1, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return command.size() > 2 ? nullptr : new Subscribe(command.size() == 2 ? command[1].toString() : "");
+    }},
+    {"unsubscribe", 2, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new Unsubscribe(command[1].toInt());
+    }},
+    {"record", -1, [](const vector<ArgumentView>& command) -> BaseAction* {
+        if (command.size() == 2 && command[1] == "stop") {
+            return new StopRecording();
         }
-        if (command[0] == "backup") {
-            action = new BackupSimulation();
+        if (command.size() < 3) {
+            return nullptr;
         }
-        if (command[0] == "restore") {
-            action = new RestoreSimulation();
+        bool delta = command.size() > 3 && command[3] == "delta";
+        vector<int> planIds;
+        for (size_t i = delta ? 4 : 3; i < command.size(); i++) {
+            planIds.push_back(command[i].toInt());
         }
-        if (command[0] == "close") {
-            action = new Close();
-            isRunning = false;
+        return new Record(command[1].toString(), command[2].toInt(), delta, planIds);
+    }},
+    {"mem", -1, [](const vector<ArgumentView>& command) -> BaseAction* {
+        if (command.size() == 1) {
+            return new PrintMemory();
         }
+        return command.size() == 3 && command[1] == "budget" ? new SetMemoryBudget(command[2].toString()) : nullptr;
+    }},
+    {"stats", -1, [](const vector<ArgumentView>& command) -> BaseAction* {
+        return new PrintStats(command.size() > 1 ? command[1].toString() : "");
+    }},
+};
 
-        if (action != nullptr) {
-            action->act(*this);
-        }else {
-            cout << "Unknown command: " << command[0] << endl;
+// Command names bucketed by length, so a lookup compares against one or two names at most.
+static const CommandEntry* findCommand(const ArgumentView& name) {
+    static const size_t maxNameLength = 16;
+    static const vector<vector<const CommandEntry*>> byLength = []() {
+        vector<vector<const CommandEntry*>> buckets(maxNameLength + 1);
+        for (const CommandEntry& entry: commandTable) {
+            buckets[std::strlen(entry.name)].push_back(&entry);
         }
+        return buckets;
+    }();
+    if (name.length > maxNameLength) {
+        return nullptr;
     }
-    cout << "The simulation has ended" << endl;
+    for (const CommandEntry* entry: byLength[name.length]) {
+        if (std::memcmp(entry->name, name.data, name.length) == 0) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+BaseAction* Simulation:: parseAction(const vector<ArgumentView>& command) {
+    const CommandEntry* entry = findCommand(command[0]);
+    if (entry == nullptr || (entry->numOfArguments != -1 && entry->numOfArguments != (int)command.size())) {
+        return nullptr;
+    }
+    return entry->factory(command);
 }
 
 void Simulation:: addPlan(const Settlement& settlement, SelectionPolicy* selectionPolicy) {
-    plans.push_back(std::move(Plan(planCounter, settlement, selectionPolicy, facilitiesOptions)));
+    waitForBackup();
+    if (planCounter % numOfShards == shardIndex) {
+        Plan& plan = plans.add(Plan(planCounter, settlement, selectionPolicy, *facilitiesOptions));
+        leaderboard.insert(planCounter, PlanScores());
+        rollups.insert(plan);
+        plan.setEventChannel(events);
+        plan.setHistory(history.get());
+        if (store != nullptr) {
+            // a stored plan has a record of its own instead of a twin.
+            plan.setStore(store.get());
+        }else {
+            // plans added in the same state evolve alike, so they share it until one changes alone.
+            string key = std::to_string(settlement.getBuildCapacity()) + " " + plan.stateToString();
+            std::unordered_map<string, int>::iterator twin = twinCandidates.find(key);
+            if (twin != twinCandidates.end() && isPlanExists(twin->second) && plan.isTwinOf(getPlan(twin->second))) {
+                plan.joinTwin(getPlan(twin->second));
+            }else {
+                twinCandidates[key] = planCounter;
+            }
+        }
+    }else {
+        delete selectionPolicy;
+    }
     planCounter++;
 }
 
 void Simulation:: addAction(BaseAction* action) {
     actionsLog.push_back(action);
+    // measuring walks the whole state, so it is done every few actions and not after each one.
+    static const int actionsPerRelief = 64;
+    if (memoryBudget != 0 && ++actionsSinceRelief >= actionsPerRelief) {
+        relieveMemory();
+    }
 }
 
 bool Simulation:: addSettlement(Settlement* settlement){
@@ -124,15 +354,174 @@ bool Simulation:: addSettlement(Settlement* settlement){
 }
 
 bool Simulation:: addFacility(FacilityType facility){
-    for(FacilityType facility1: facilitiesOptions) {
+    waitForBackup();
+    for(const FacilityType& facility1: *facilitiesOptions) {
         if (facility1.getName() == facility.getName()) {
             return false;
         }   
     }
-    facilitiesOptions.push_back(facility);
+    detachCatalog();
+    facilitiesOptions->push_back(facility);
     return true;
 }
 
+bool Simulation:: loadCatalog(const string& catalogFilePath){
+    waitForBackup();
+    // every simulation of the process that starts from the same catalog file shares one copy of it,
+    // the cache keeps a reference so the copy is never modified in place.
+    static std::mutex cacheLock;
+    static std::map<string, std::shared_ptr<vector<FacilityType>>> cache;
+    std::lock_guard<std::mutex> lock(cacheLock);
+    std::map<string, std::shared_ptr<vector<FacilityType>>>::const_iterator cached = cache.find(catalogFilePath);
+    if (cached != cache.end() && facilitiesOptions->empty()) {
+        facilitiesOptions = cached->second;
+        rebindCatalog();
+        return true;
+    }
+
+    std::shared_ptr<vector<FacilityType>> catalog = std::make_shared<vector<FacilityType>>();
+    if (!CatalogFile:: load(catalogFilePath, *catalog)) {
+        return false;
+    }
+    if (facilitiesOptions->empty()) {
+        cache[catalogFilePath] = catalog;
+        facilitiesOptions = catalog;
+        rebindCatalog();
+        return true;
+    }
+    // facilities already defined keep their place, like repeated facility lines.
+    std::unordered_set<string> names;
+    for (const FacilityType& facility: *facilitiesOptions) {
+        names.insert(facility.getName());
+    }
+    detachCatalog();
+    for (const FacilityType& facility: *catalog) {
+        if (names.insert(facility.getName()).second) {
+            facilitiesOptions->push_back(facility);
+        }
+    }
+    return true;
+}
+
+bool Simulation:: setHistoryFile(const string& historyFilePath){
+    waitForBackup();
+    // simulations of the process that use the same file share it, every shard has a file of its own.
+    static std::mutex cacheLock;
+    static std::map<string, std::weak_ptr<FacilityHistory>> cache;
+    string filePath = numOfShards == 1 ? historyFilePath : historyFilePath + "." + std::to_string(shardIndex);
+    std::lock_guard<std::mutex> lock(cacheLock);
+    std::shared_ptr<FacilityHistory> opened = cache[filePath].lock();
+    if (opened == nullptr) {
+        opened = FacilityHistory:: open(filePath);
+        if (opened == nullptr) {
+            return false;
+        }
+        cache[filePath] = opened;
+    }
+    history = opened;
+    for (Plan& plan: plans) {
+        plan.setHistory(history.get());
+    }
+    return true;
+}
+
+bool Simulation:: setStoreFile(const string& storeFilePath){
+    waitForBackup();
+    // every shard has a file of its own, and so do simulations of the process that name the same file.
+    static std::mutex inUseLock;
+    static std::map<string, std::weak_ptr<PlanStore>> inUse;
+    string filePath = numOfShards == 1 ? storeFilePath : storeFilePath + "." + std::to_string(shardIndex);
+    std::lock_guard<std::mutex> lock(inUseLock);
+    std::shared_ptr<PlanStore> sharing = inUse[filePath].lock();
+    std::shared_ptr<PlanStore> opened = sharing == nullptr ? PlanStore:: open(filePath, numOfShards) : sharing->emptyCopy();
+    if (opened == nullptr) {
+        return false;
+    }
+    if (sharing == nullptr) {
+        inUse[filePath] = opened;
+    }
+    store = opened;
+    // a record holds the state of one plan, so twins part first.
+    for (Plan& plan: plans) {
+        plan.leaveTwins();
+        plan.setStore(store.get());
+    }
+    twinCandidates.clear();
+    return true;
+}
+
+bool Simulation:: openJournal(const string& journalFilePath){
+    SPL_STATS_TIMER(Stats:: RECOVERY);
+    vector<string> journaled;
+    Journal* opened = Journal:: open(journalFilePath, journaled);
+    if (opened == nullptr) {
+        return false;
+    }
+    // the replayed commands rebuild the state and the actions log, what they printed was seen before.
+    // They run as in a started simulation, so the backups they take restore to a running one.
+    std::ostream* shown = output;
+    std::ostream discarded(nullptr);
+    output = &discarded;
+    bool wasRunning = isRunning;
+    isRunning = true;
+    vector<ArgumentView> command;
+    for (const string& line: journaled) {
+        Auxiliary:: parseArguments(line, command);
+        BaseAction* action = command.empty() ? nullptr : parseAction(command);
+        if (action != nullptr) {
+            action->act(*this);
+        }
+    }
+    output = shown;
+    isRunning = wasRunning;
+    if (backup != nullptr) {
+        backup->setOutput(*shown);
+    }
+    delete journal;
+    journal = opened;
+    return true;
+}
+
+// The commands whose effects a restart must rebuild.
+bool Simulation:: isJournaled(const BaseAction& action){
+    static const char* journaled[] = {"step ", "plan ", "settlement ", "facility ", "changePolicy ", "endPlan ", "backup", "restore", "mem budget "};
+    string description = action.toString();
+    for (const char* prefix: journaled) {
+        if (description.compare(0, std::strlen(prefix), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Simulation:: commitJournal(std::ostringstream& held, std::ostream& shown){
+    if (journal == nullptr) {
+        return;
+    }
+    if (!journal->commit()) {
+        std::cerr << "Cannot write the journal" << endl;
+    }
+    shown << held.str() << std::flush;
+    held.str("");
+}
+
+//helper method, gives this simulation a private catalog before it is modified.
+void Simulation:: detachCatalog(){
+    if (facilitiesOptions.use_count() == 1) {
+        return;
+    }
+    facilitiesOptions = std::make_shared<vector<FacilityType>>(*facilitiesOptions);
+    rebindCatalog();
+}
+
+//helper method, points the plans at the current catalog.
+void Simulation:: rebindCatalog(){
+    for (Plan& plan: plans) {
+        plan.setFacilityOptions(*facilitiesOptions);
+    }
+    unknownPlan->setFacilityOptions(*facilitiesOptions);
+}
+
 bool Simulation:: isSettlementExists(const string& settlementName) const{
     for (Settlement* settlement: settlements) {
         if (settlement->getName() == settlementName) {
@@ -152,23 +541,354 @@ Settlement& Simulation:: getSettlement(const string& settlementName){
 }
 
 Plan& Simulation:: getPlan(const int planID) {
-    if (planID < (int)plans.size()) {
-        return plans[planID];
+    if (isPlanExists(planID)) {
+        return *plans.find(planID);
+    }
+    return *unknownPlan;
+}
+
+const Plan& Simulation:: getPlan(const int planID) const {
+    if (isPlanExists(planID)) {
+        return *plans.find(planID);
     }
     return *unknownPlan;
 }
 
+void Simulation:: setPlanPolicy(int planId, SelectionPolicy* selectionPolicy){
+    Plan& plan = getPlan(planId);
+    preserve(plan);
+    string previousPolicy = plan.getSelectionPolicy()->toString();
+    plan.setSelectionPolicy(selectionPolicy);
+    rollups.changePolicy(plan, previousPolicy);
+    flushEvents();
+}
+
+bool Simulation:: endPlan(int planId){
+    if (!isPlanExists(planId)) {
+        return false;
+    }
+    waitForBackup();
+    Plan& plan = getPlan(planId);
+    leaderboard.erase(planId, PlanScores(plan));
+    rollups.erase(plan);
+    plan.quitTwins();
+    // the slot stays empty, the other plans do not move.
+    plans.erase(planId);
+    return true;
+}
+
+int Simulation:: subscribe(const EventChannel::Subscriber& subscriber){
+    if (events == nullptr) {
+        events = new EventChannel();
+        rebindEvents();
+    }
+    return events->subscribe(subscriber);
+}
+
+bool Simulation:: unsubscribe(int subscriberId){
+    return events != nullptr && events->unsubscribe(subscriberId);
+}
+
+//helper method, points the plans at the event channel.
+void Simulation:: rebindEvents(){
+    for (Plan& plan: plans) {
+        plan.setEventChannel(events);
+    }
+}
+
+//helper method, delivers the events of the last step or policy change.
+void Simulation:: flushEvents(){
+    if (events != nullptr) {
+        events->flush(getOutput());
+    }
+}
+
+bool Simulation:: startRecording(const string& filePath, int interval, bool delta, const vector<int>& planIds){
+    // every shard records its own plans, into its own file.
+    Recorder* started = Recorder:: open(numOfShards == 1 ? filePath : filePath + "." + std::to_string(shardIndex), interval, delta, planIds);
+    if (started == nullptr) {
+        return false;
+    }
+    delete recorder;
+    recorder = started;
+    recorder->record(ticks, plans);
+    return true;
+}
+
+bool Simulation:: stopRecording(){
+    if (recorder == nullptr) {
+        return false;
+    }
+    delete recorder;
+    recorder = nullptr;
+    return true;
+}
+
 void Simulation:: step(){
     for(Plan& plan: plans) {
+        // twins share one state, stepping the first steps them all.
+        if (!plan.leadsTwins()) {
+            continue;
+        }
+        preserve(plan);
+        PlanSummary before(plan);
         plan.step();
+        updateTwins(plan, before);
+    }
+    ticks++;
+    if (recorder != nullptr && ticks % recorder->getInterval() == 0) {
+        recorder->record(ticks, plans);
+    }
+    flushEvents();
+}
+
+void Simulation:: step(int numOfSteps){
+    // while recording, the plans are advanced up to each sampled tick in turn.
+    while (numOfSteps > 0) {
+        int numOfAdvanced = numOfSteps;
+        if (recorder != nullptr) {
+            numOfAdvanced = std::min(numOfSteps, recorder->getInterval() - ticks % recorder->getInterval());
+        }
+        advancePlans(numOfAdvanced);
+        numOfSteps -= numOfAdvanced;
+        ticks += numOfAdvanced;
+        if (recorder != nullptr && ticks % recorder->getInterval() == 0) {
+            recorder->record(ticks, plans);
+        }
+    }
+    flushEvents();
+}
+
+//helper method.
+void Simulation:: advancePlans(int numOfSteps){
+    for(Plan& plan: plans) {
+        if (!plan.leadsTwins()) {
+            continue;
+        }
+        preserve(plan);
+        PlanSummary before(plan);
+        plan.advance(numOfSteps);
+        updateTwins(plan, before);
+    }
+}
+void Simulation:: updateTwins(const Plan& plan, const PlanSummary& before){
+    PlanSummary after(plan);
+    if (after == before) {
+        return;
+    }
+    if (!plan.hasTwins()) {
+        leaderboard.update(plan.getPlanId(), before.scores, after.scores);
+        rollups.update(plan, before, after);
+        return;
+    }
+    for (int planId: plan.getTwins()) {
+        leaderboard.update(planId, before.scores, after.scores);
+        rollups.update(getPlan(planId), before, after);
+    }
+}
+
+void Simulation:: setLazySteps(bool lazySteps){
+    this->lazySteps = lazySteps;
+}
+
+bool Simulation:: isLazySteps() const{
+    return lazySteps;
+}
+
+void Simulation:: setBackgroundBackups(bool backgroundBackups){
+    this->backgroundBackups = backgroundBackups;
+}
+
+bool Simulation:: isBackgroundBackups() const{
+    return backgroundBackups;
+}
+
+void Simulation:: deferSteps(int numOfSteps){
+    // runs what is pending rather than let the count overflow.
+    if (numOfSteps > INT_MAX - pendingSteps) {
+        flushPendingSteps();
+    }
+    pendingSteps += numOfSteps;
+}
+
+void Simulation:: flushPendingSteps(){
+    if (pendingSteps > 0) {
+        int numOfSteps = pendingSteps;
+        pendingSteps = 0;
+        step(numOfSteps);
+    }
+}
+
+bool Simulation:: saveBackup(){
+    SPL_STATS_TIMER(Stats:: BACKUP);
+    waitForBackup();
+    if (memoryBudget != 0) {
+        // the copy shares the catalog and replaces the current backup.
+        MemoryUsage usage = getMemoryUsage();
+        size_t copy = sizeof(Simulation) + usage.total() - usage.catalog - usage.backup - usage.events - usage.recorder;
+        if (usage.total() - usage.backup + copy > memoryBudget) {
+            return false;
+        }
+    }
+    delete backup;
+    if (!backgroundBackups) {
+        backup = new Simulation(*this);
+        return true;
+    }
+    // everything but the plans is copied now, the plans are copied as they are now while commands keep running.
+    Simulation* target = new Simulation(*this, false);
+    backup = target;
+    backupInFlight = new PlanSnapshot(plans, [target](const Plan& plan) {
+        return new Plan(plan, target->getSettlement(plan.getSettlement().getName()), *target->facilitiesOptions);
+    }, [target](vector<Plan*>& copies) {
+        target->adoptPlans(copies);
+    });
+    return true;
+}
+
+//helper method.
+void Simulation:: waitForBackup(){
+    if (backupInFlight != nullptr) {
+        backupInFlight->wait();
+        delete backupInFlight;
+        backupInFlight = nullptr;
+    }
+}
+
+//helper method.
+void Simulation:: preserve(const Plan& plan){
+    if (backupInFlight == nullptr) {
+        return;
+    }
+    if (!plan.hasTwins()) {
+        backupInFlight->preserve(plans.slotOf(plan.getPlanId()));
+        return;
+    }
+    for (int planId: plan.getTwins()) {
+        backupInFlight->preserve(plans.slotOf(planId));
+    }
+}
+
+//helper method, runs on the helper thread of a background backup.
+void Simulation:: adoptPlans(vector<Plan*>& copies){
+    // every copy was taken with its own state, twins share the state of the first again.
+    for (Plan* copy: copies) {
+        if (copy == nullptr) {
+            continue;
+        }
+        Plan& plan = plans.add(std::move(*copy));
+        delete copy;
+        if (!plan.leadsTwins()) {
+            plan.joinTwin(getPlan(plan.getTwins().front()));
+        }
+        plan.setStore(store.get());
+        leaderboard.insert(plan.getPlanId(), PlanScores(plan));
+        rollups.insert(plan);
+    }
+}
+
+bool Simulation:: restoreBackup(){
+    SPL_STATS_TIMER(Stats:: RESTORE);
+    waitForBackup();
+    if (backup == nullptr) {
+        return false;
+    }
+    *this = *backup;
+    return true;
+}
+
+const std::shared_ptr<vector<FacilityType>>& Simulation:: getCatalog() const{
+    return facilitiesOptions;
+}
+
+bool Simulation:: shareCatalog(const std::shared_ptr<vector<FacilityType>>& catalog){
+    waitForBackup();
+    if (catalog == facilitiesOptions || catalog->size() != facilitiesOptions->size()) {
+        return catalog == facilitiesOptions;
+    }
+    for (size_t i = 0; i < catalog->size(); i++) {
+        const FacilityType& mine = (*facilitiesOptions)[i];
+        const FacilityType& theirs = (*catalog)[i];
+        if (mine.getName() != theirs.getName() || mine.getCategory() != theirs.getCategory() || mine.getCost() != theirs.getCost() ||
+            mine.getLifeQualityScore() != theirs.getLifeQualityScore() || mine.getEconomyScore() != theirs.getEconomyScore() ||
+            mine.getEnvironmentScore() != theirs.getEnvironmentScore()) {
+            return false;
+        }
+    }
+    facilitiesOptions = catalog;
+    rebindCatalog();
+    return true;
+}
+
+//helper function, writes the reports in order. On cout they go out in one vectored write after what cout holds.
+static void writeReports(std::ostream& out, const vector<string>& reports) {
+    if (&out != &std::cout) {
+        for (const string& report: reports) {
+            out << report;
+        }
+        out.flush();
+        return;
+    }
+    std::cout.flush();
+    vector<iovec> parts;
+    for (const string& report: reports) {
+        if (!report.empty()) {
+            parts.push_back({const_cast<char*>(report.data()), report.size()});
+        }
+    }
+    size_t next = 0;
+    while (next < parts.size()) {
+        ssize_t written = writev(STDOUT_FILENO, &parts[next], std::min<size_t>(parts.size() - next, IOV_MAX));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout.setstate(std::ios::badbit);
+            return;
+        }
+        // a pipe may take part of the reports, the rest is written from where it stopped.
+        for (; next < parts.size() && (size_t)written >= parts[next].iov_len; next++) {
+            written -= parts[next].iov_len;
+        }
+        if (written > 0) {
+            parts[next].iov_base = (char*)parts[next].iov_base + written;
+            parts[next].iov_len -= written;
+        }
     }
 }
 
 void Simulation:: close(){
+    flushPendingSteps();
     isRunning = false;
-    for(const Plan& item: plans) {
-        item.printplan();
+    SPL_STATS_TIMER(Stats:: OUTPUT);
+    // formatting the reports of many plans costs more than the run itself, so every thread formats
+    // a contiguous range of plans into its own buffer, and the buffers are written in plan order.
+    static const size_t minPlansPerThread = 4096;
+    size_t numOfThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                           (plans.size() + minPlansPerThread - 1) / minPlansPerThread);
+    vector<string> reports(std::max<size_t>(numOfThreads, 1));
+    vector<std::thread> workers;
+    for (size_t i = 0; i < reports.size(); i++) {
+        size_t first = plans.numOfSlots() * i / reports.size();
+        size_t last = plans.numOfSlots() * (i + 1) / reports.size();
+        auto format = [this, &reports, i, first, last]() {
+            for (size_t slot = first; slot < last; slot++) {
+                const Plan* plan = plans.at(slot);
+                if (plan != nullptr) {
+                    plan->appendReport(reports[i]);
+                }
+            }
+        };
+        if (i + 1 < reports.size()) {
+            workers.push_back(std::thread(format));
+        }else {
+            format();
+        }
     }
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+    writeReports(getOutput(), reports);
 }
 
 void Simulation:: open() {
@@ -176,50 +896,194 @@ void Simulation:: open() {
     start();
 }
 
+MemoryUsage Simulation:: getMemoryUsage() const{
+    MemoryUsage usage;
+    usage.catalog = MemoryUsage:: ofVector(*facilitiesOptions);
+    for (const FacilityType& facility: *facilitiesOptions) {
+        usage.catalog += MemoryUsage:: ofString(facility.getName());
+    }
+    usage.plans = plans.memoryUsage();
+    for (const Plan& plan: plans) {
+        // twins share the state of the first, a stored plan has its state in the store file.
+        if (plan.leadsTwins() && !plan.isStored()) {
+            usage.plans += sizeof(PlanState) + MemoryUsage:: ofVector(plan.getTwins());
+            usage.facilities += plan.facilitiesMemoryUsage();
+            usage.policies += MemoryUsage:: ofPolicy(plan.getSelectionPolicy().get());
+        }
+    }
+    usage.settlements = MemoryUsage:: ofVector(settlements);
+    for (const Settlement* settlement: settlements) {
+        usage.settlements += sizeof(Settlement) + MemoryUsage:: ofString(settlement->getName());
+    }
+    usage.actionsLog = MemoryUsage:: ofVector(actionsLog) + MemoryUsage:: ofVector(spilledActions);
+    for (const BaseAction* action: actionsLog) {
+        usage.actionsLog += sizeof(BaseAction) + action->toString().size();
+    }
+    usage.indexes = leaderboard.memoryUsage() + rollups.memoryUsage();
+    for (const std::pair<const string, int>& candidate: twinCandidates) {
+        usage.indexes += sizeof(candidate) + 2 * sizeof(void*) + MemoryUsage:: ofString(candidate.first);
+    }
+    if (events != nullptr) {
+        usage.events = sizeof(EventChannel) + events->memoryUsage();
+    }
+    if (recorder != nullptr) {
+        usage.recorder = sizeof(Recorder) + recorder->memoryUsage();
+    }
+    if (backupInFlight != nullptr) {
+        // the helper is still copying, the copy is about the size of the state it copies.
+        usage.backup = sizeof(Simulation) + usage.total() - usage.catalog - usage.events - usage.recorder;
+    }else if (backup != nullptr) {
+        MemoryUsage backupUsage = backup->getMemoryUsage();
+        if (backup->facilitiesOptions == facilitiesOptions) {
+            backupUsage.catalog = 0;
+        }
+        usage.backup = sizeof(Simulation) + backupUsage.total();
+    }
+    return usage;
+}
+
+void Simulation:: setMemoryBudget(size_t memoryBudget){
+    this->memoryBudget = memoryBudget;
+    if (memoryBudget != 0) {
+        relieveMemory();
+    }
+}
+
+size_t Simulation:: getMemoryBudget() const{
+    return memoryBudget;
+}
+
+void Simulation:: readActionsLog(vector<string>& lines) const{
+    // a spilled line is the action, its status and the status of its clones, separated by tabs.
+    for (size_t i = 0; i < spilledActions.size(); i++) {
+        vector<string> spilled;
+        actionSpill->read(spilledActions[i], spilled);
+        for (const string& line: spilled) {
+            size_t live = line.find('\t');
+            size_t cloned = line.find('\t', live + 1);
+            lines.push_back(line.substr(0, live) + (i < numOfClonedSpills ? line.substr(cloned + 1) : line.substr(live + 1, cloned - live - 1)));
+        }
+    }
+    for (const BaseAction* action: actionsLog) {
+        lines.push_back(action->toString() + statusToString(action->getStatus()));
+    }
+}
+
+//helper method, applied while the memory in use is within a tenth of the budget: first releases
+//spare capacity, then moves the actions log to a temporary file.
+void Simulation:: relieveMemory(){
+    // plans are not moved while a background backup copies them, relief waits for the next action.
+    if (backupInFlight != nullptr) {
+        return;
+    }
+    actionsSinceRelief = 0;
+    if (getMemoryUsage().total() < memoryBudget - memoryBudget / 10) {
+        return;
+    }
+    plans.compact();
+    for (Plan& plan: plans) {
+        plan.compact();
+    }
+    settlements.shrink_to_fit();
+    if (getMemoryUsage().total() >= memoryBudget - memoryBudget / 10) {
+        spillActions();
+    }
+}
+
+//helper method, spills every logged action but the last one, which may still be running.
+void Simulation:: spillActions(){
+    if (actionsLog.size() < 2) {
+        return;
+    }
+    if (actionSpill == nullptr) {
+        actionSpill.reset(ActionSpill:: create());
+        if (actionSpill == nullptr) {
+            return;
+        }
+    }
+    string lines;
+    for (size_t i = 0; i + 1 < actionsLog.size(); i++) {
+        BaseAction* clone = actionsLog[i]->clone();
+        lines += actionsLog[i]->toString() + '\t' + statusToString(actionsLog[i]->getStatus()) + '\t' + statusToString(clone->getStatus()) + '\n';
+        delete clone;
+        delete actionsLog[i];
+    }
+    std::pair<long, long> range = actionSpill->append(lines);
+    if (spilledActions.size() > numOfClonedSpills && spilledActions.back().second == range.first) {
+        spilledActions.back().second = range.second;
+    }else {
+        spilledActions.push_back(range);
+    }
+    actionsLog.erase(actionsLog.begin(), actionsLog.end() - 1);
+    actionsLog.shrink_to_fit();
+}
+
 //rule of 5.
-Simulation:: Simulation(const Simulation& other): isRunning(other.isRunning), planCounter(other.planCounter),actionsLog(),plans(),settlements(), facilitiesOptions(), unknownSettlement(new Settlement("ThereIsNon", SettlementType:: VILLAGE)), unknownPlan(new Plan(-1, *unknownSettlement, new EconomySelection, facilitiesOptions)){
-    for (const FacilityType& item: other.facilitiesOptions) {
-        this->facilitiesOptions.push_back(item);
-    }   
+Simulation:: Simulation(const Simulation& other): Simulation(other, true) {}
+
+Simulation:: Simulation(const Simulation& other, bool copyPlans): isRunning(other.isRunning), planCounter(other.planCounter), shardIndex(other.shardIndex), numOfShards(other.numOfShards), lazySteps(other.lazySteps), backgroundBackups(other.backgroundBackups), pendingSteps(other.pendingSteps), ticks(other.ticks),actionsLog(),actionSpill(other.actionSpill),spilledActions(other.spilledActions),numOfClonedSpills(other.spilledActions.size()),memoryBudget(other.memoryBudget),actionsSinceRelief(0),plans(other.numOfShards),twinCandidates(other.twinCandidates),leaderboard(copyPlans ? other.leaderboard : Leaderboard()),rollups(copyPlans ? other.rollups : Rollups()),settlements(), facilitiesOptions(other.facilitiesOptions), history(other.history), store(other.store == nullptr ? nullptr : other.store->emptyCopy()), unknownSettlement(new Settlement("ThereIsNon", SettlementType:: VILLAGE)), unknownPlan(new Plan(-1, *unknownSettlement, new EconomySelection, *facilitiesOptions)), output(other.output), backup(nullptr), backupInFlight(nullptr), events(nullptr), recorder(nullptr), journal(nullptr){
     for (BaseAction* item : other.actionsLog) {
         actionsLog.push_back(item->clone());
     }
     for (Settlement* item: other.settlements) {
         settlements.push_back(new Settlement(*item));
     }
-    for (const Plan& item: other.plans) {
-        Settlement& newSettlement = getSettlement(item.getSettlement().getName());
-        plans.push_back(Plan(item, newSettlement, facilitiesOptions));
+    if (copyPlans) {
+        this->copyPlans(other.plans);
     }
+}
 
+void Simulation:: copyPlans(const PlanSlots& others){
+    for (const Plan& item: others) {
+        Settlement& newSettlement = getSettlement(item.getSettlement().getName());
+        if (item.leadsTwins()) {
+            plans.add(Plan(item, newSettlement, *facilitiesOptions)).setStore(store.get());
+        }else {
+            plans.add(Plan(item, newSettlement, getPlan(item.getTwins().front())));
+        }
+    }
 }
 
 Simulation& Simulation:: operator= (const Simulation& other) {
     if (this != &other) {
-        plans.clear();
-        facilitiesOptions.clear();
+        waitForBackup();
+        plans = PlanSlots(other.numOfShards);
         
         this->Clean();
         
         isRunning = other.isRunning;
         planCounter = other.planCounter;
+        shardIndex = other.shardIndex;
+        numOfShards = other.numOfShards;
+        pendingSteps = other.pendingSteps;
+        ticks = other.ticks;
+        twinCandidates = other.twinCandidates;
+        actionSpill = other.actionSpill;
+        spilledActions = other.spilledActions;
+        numOfClonedSpills = other.spilledActions.size();
+        memoryBudget = other.memoryBudget;
+        leaderboard = other.leaderboard;
+        rollups = other.rollups;
+        facilitiesOptions = other.facilitiesOptions;
+        history = other.history;
+        // the plans of this simulation are gone, so its store is reused.
+        if (other.store == nullptr) {
+            store.reset();
+        }else if (store == nullptr) {
+            store = other.store->emptyCopy();
+        }
         
         unknownSettlement = new Settlement("ThereIsNon", SettlementType::VILLAGE);
-        unknownPlan = new Plan(-1, *unknownSettlement, new EconomySelection(), facilitiesOptions);
+        unknownPlan = new Plan(-1, *unknownSettlement, new EconomySelection(), *facilitiesOptions);
         
-        for (const FacilityType& item : other.facilitiesOptions) {
-            facilitiesOptions.push_back(item);
-        }
         for (BaseAction* item : other.actionsLog) {
             actionsLog.push_back(item->clone());
         }
         for (Settlement* item : other.settlements) {
             settlements.push_back(new Settlement(*item));
         }
-        for (const Plan& item : other.plans) {
-            Settlement& newSettlement = getSettlement(item.getSettlement().getName());
-            plans.push_back(Plan(item, newSettlement, facilitiesOptions));
-        }
+        copyPlans(other.plans);
+        rebindEvents();
     }
     return *this;
 }
@@ -227,33 +1091,87 @@ Simulation& Simulation:: operator= (const Simulation& other) {
 Simulation::Simulation(Simulation&& other)
     : isRunning(other.isRunning),
       planCounter(other.planCounter),
+      shardIndex(other.shardIndex),
+      numOfShards(other.numOfShards),
+      lazySteps(other.lazySteps),
+      backgroundBackups(other.backgroundBackups),
+      pendingSteps(other.pendingSteps),
+      ticks(other.ticks),
       actionsLog(std::move(other.actionsLog)),
+      actionSpill(std::move(other.actionSpill)),
+      spilledActions(std::move(other.spilledActions)),
+      numOfClonedSpills(other.numOfClonedSpills),
+      memoryBudget(other.memoryBudget),
+      actionsSinceRelief(other.actionsSinceRelief),
       plans(std::move(other.plans)),
+      twinCandidates(std::move(other.twinCandidates)),
+      leaderboard(std::move(other.leaderboard)),
+      rollups(std::move(other.rollups)),
       settlements(std::move(other.settlements)),
       facilitiesOptions(std::move(other.facilitiesOptions)),
+      history(std::move(other.history)),
+      store(std::move(other.store)),
       unknownSettlement(other.unknownSettlement),
-      unknownPlan(other.unknownPlan){
+      unknownPlan(other.unknownPlan),
+      output(other.output),
+      backup(other.backup),
+      backupInFlight(other.backupInFlight),
+      events(other.events),
+      recorder(other.recorder),
+      journal(other.journal){
     other.unknownSettlement = nullptr;
     other.unknownPlan = nullptr;
+    other.backup = nullptr;
+    other.backupInFlight = nullptr;
+    other.events = nullptr;
+    other.recorder = nullptr;
+    other.journal = nullptr;
 }
 
 Simulation& Simulation::operator=(Simulation&& other) {
     if (this != &other) {
+        waitForBackup();
         plans.clear();
-        facilitiesOptions.clear();
         Clean();
         isRunning = other.isRunning;
         planCounter = other.planCounter;
+        shardIndex = other.shardIndex;
+        numOfShards = other.numOfShards;
+        pendingSteps = other.pendingSteps;
+        ticks = other.ticks;
         
         unknownSettlement = other.unknownSettlement;
         unknownPlan = other.unknownPlan;
         other.unknownSettlement = nullptr;
         other.unknownPlan = nullptr;
+        delete backup;
+        backup = other.backup;
+        other.backup = nullptr;
+        backupInFlight = other.backupInFlight;
+        other.backupInFlight = nullptr;
+        delete events;
+        events = other.events;
+        other.events = nullptr;
+        delete recorder;
+        recorder = other.recorder;
+        other.recorder = nullptr;
+        delete journal;
+        journal = other.journal;
+        other.journal = nullptr;
         
         facilitiesOptions = std::move(other.facilitiesOptions);
+        history = std::move(other.history);
+        store = std::move(other.store);
         actionsLog = std::move(other.actionsLog);
+        actionSpill = std::move(other.actionSpill);
+        spilledActions = std::move(other.spilledActions);
+        numOfClonedSpills = other.numOfClonedSpills;
+        memoryBudget = other.memoryBudget;
         settlements = std::move(other.settlements);
         plans = std::move(other.plans);
+        twinCandidates = std::move(other.twinCandidates);
+        leaderboard = std::move(other.leaderboard);
+        rollups = std::move(other.rollups);
     }
     return *this;
 }
@@ -276,5 +1194,10 @@ void Simulation::Clean(){
 }
 
 Simulation:: ~Simulation() {
+    waitForBackup();
     Clean();
+    delete backup;
+    delete events;
+    delete recorder;
+    delete journal;
 }
@@ -0,0 +1,147 @@
+#include "SimulationApi.h"
+#include "Simulation.h"
+#include "Action.h"
+#include <algorithm>
+SelectionPolicy* selectionPolicyFromString(const string& selectionPolicy);
+
+struct spl_simulation {
+    spl_simulation(const string& configFilePath): simulation(configFilePath), actionLogging(false), discard(nullptr) {
+        simulation.setOutput(discard);
+    }
+    spl_simulation(const spl_simulation& other): simulation(other.simulation), actionLogging(other.actionLogging), discard(nullptr) {
+        simulation.setOutput(discard);
+    }
+    spl_simulation& operator= (const spl_simulation& other) = delete;
+    Simulation simulation;
+    bool actionLogging;
+    std::ostream discard;
+};
+
+// Runs a REPL action so it is logged, the simulation takes ownership of it.
+static bool runLogged(spl_simulation* simulation, BaseAction* action) {
+    action->act(simulation->simulation);
+    return action->getStatus() == ActionStatus:: COMPLETED;
+}
+
+spl_simulation* spl_simulation_create(const char* config_path) {
+    return new spl_simulation(config_path == nullptr ? "" : config_path);
+}
+
+void spl_simulation_destroy(spl_simulation* simulation) {
+    delete simulation;
+}
+
+void spl_simulation_set_action_logging(spl_simulation* simulation, int enabled) {
+    simulation->actionLogging = enabled != 0;
+}
+
+int spl_simulation_add_settlement(spl_simulation* simulation, const char* name, int type) {
+    if (simulation->actionLogging) {
+        return runLogged(simulation, new AddSettlement(name, (SettlementType)type));
+    }
+    return simulation->simulation.addSettlement(new Settlement(name, (SettlementType)type));
+}
+
+int spl_simulation_add_facility(spl_simulation* simulation, const spl_facility* facility) {
+    if (simulation->actionLogging) {
+        return runLogged(simulation, new AddFacility(facility->name, (FacilityCategory)facility->category, facility->price,
+            facility->life_quality_score, facility->economy_score, facility->environment_score));
+    }
+    return simulation->simulation.addFacility(FacilityType(facility->name, (FacilityCategory)facility->category, facility->price,
+        facility->life_quality_score, facility->economy_score, facility->environment_score));
+}
+
+int spl_simulation_add_facilities(spl_simulation* simulation, const spl_facility* facilities, int count) {
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        added += spl_simulation_add_facility(simulation, &facilities[i]);
+    }
+    return added;
+}
+
+int spl_simulation_add_plan(spl_simulation* simulation, const char* settlement_name, const char* policy) {
+    Simulation& engine = simulation->simulation;
+    if (simulation->actionLogging) {
+        if (!runLogged(simulation, new AddPlan(settlement_name, policy))) {
+            return -1;
+        }
+    }else {
+        if (!engine.isSettlementExists(settlement_name)) {
+            return -1;
+        }
+        engine.addPlan(engine.getSettlement(settlement_name), selectionPolicyFromString(policy));
+    }
+    // the plan just added holds the last slot.
+    return engine.getPlans().at(engine.getPlans().numOfSlots() - 1)->getPlanId();
+}
+
+int spl_simulation_change_policy(spl_simulation* simulation, int plan_id, const char* policy) {
+    Simulation& engine = simulation->simulation;
+    if (simulation->actionLogging) {
+        return runLogged(simulation, new ChangePlanPolicy(plan_id, policy));
+    }
+    if (!engine.isPlanExists(plan_id) || engine.getPlan(plan_id).getSelectionPolicy()->toString() == policy) {
+        return 0;
+    }
+    engine.setPlanPolicy(plan_id, selectionPolicyFromString(policy));
+    return 1;
+}
+
+int spl_simulation_end_plan(spl_simulation* simulation, int plan_id) {
+    if (simulation->actionLogging) {
+        return runLogged(simulation, new EndPlan(plan_id));
+    }
+    return simulation->simulation.endPlan(plan_id) ? 1 : 0;
+}
+
+void spl_simulation_step(spl_simulation* simulation, int num_of_steps) {
+    if (simulation->actionLogging) {
+        runLogged(simulation, new SimulateStep(num_of_steps));
+    }else {
+        simulation->simulation.step(num_of_steps);
+    }
+}
+
+int spl_simulation_plan_count(const spl_simulation* simulation) {
+    return (int)simulation->simulation.getPlans().size();
+}
+
+int spl_simulation_plan_scores(const spl_simulation* simulation, int plan_id, int scores[3]) {
+    if (!simulation->simulation.isPlanExists(plan_id)) {
+        return 0;
+    }
+    const Plan& plan = simulation->simulation.getPlan(plan_id);
+    scores[0] = plan.getlifeQualityScore();
+    scores[1] = plan.getEconomyScore();
+    scores[2] = plan.getEnvironmentScore();
+    return 1;
+}
+
+int spl_simulation_read_scores(const spl_simulation* simulation, int* plan_ids, int* life_quality, int* economy, int* environment, int capacity) {
+    const PlanSlots& plans = simulation->simulation.getPlans();
+    int count = std::min(capacity, (int)plans.size());
+    PlanSlots::const_iterator plan = plans.begin();
+    for (int i = 0; i < count; i++, ++plan) {
+        if (plan_ids != nullptr) {
+            plan_ids[i] = plan->getPlanId();
+        }
+        if (life_quality != nullptr) {
+            life_quality[i] = plan->getlifeQualityScore();
+        }
+        if (economy != nullptr) {
+            economy[i] = plan->getEconomyScore();
+        }
+        if (environment != nullptr) {
+            environment[i] = plan->getEnvironmentScore();
+        }
+    }
+    return count;
+}
+
+spl_simulation* spl_simulation_snapshot(const spl_simulation* simulation) {
+    return new spl_simulation(*simulation);
+}
+
+void spl_simulation_restore(spl_simulation* simulation, const spl_simulation* snapshot) {
+    simulation->simulation = snapshot->simulation;
+}
@@ -0,0 +1,189 @@
+#include "Stats.h"
+#include "Simulation.h"
+#include "Action.h"
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <typeinfo>
+using std::endl;
+
+static const int numOfBuckets = 48; //latency histogram buckets, bucket i holds [2^i, 2^(i+1)) ns.
+static const char* policyNames[] = {"nve", "bal", "eco", "env"};
+static const std::type_info* policyTypes[] = {&typeid(NaiveSelection), &typeid(BalancedSelection), &typeid(EconomySelection), &typeid(SustainabilitySelection)};
+static const char* timerNames[] = {"planStep", "selectFacility", "backup", "restore", "output", "journalSync", "recovery"};
+
+struct LatencyHistogram {
+    LatencyHistogram(): count(0), totalNanoseconds(0), buckets() {}
+    long long count;
+    long long totalNanoseconds;
+    long long buckets[numOfBuckets];
+};
+
+static std::atomic<bool> enabled(true);
+static std::atomic<long long> counters[Stats::NUM_OF_COUNTERS];
+static std::atomic<long long> timerNanoseconds[Stats::NUM_OF_TIMERS];
+static std::atomic<long long> timerCalls[Stats::NUM_OF_TIMERS];
+static std::mutex commandsLock;
+static std::map<string, LatencyHistogram>* commandLatencies = nullptr; //never freed, it may be used during static destruction.
+
+#ifdef SPL_STATS
+// Every allocation of the process is counted while statistics are enabled.
+void* operator new(size_t size) {
+    if (enabled.load(std::memory_order_relaxed)) {
+        counters[Stats::ALLOCATIONS].fetch_add(1, std::memory_order_relaxed);
+        counters[Stats::ALLOCATED_BYTES].fetch_add(size, std::memory_order_relaxed);
+    }
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
+bool Stats:: isCompiledIn() {
+#ifdef SPL_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Stats:: isEnabled() {
+    return isCompiledIn() && enabled.load(std::memory_order_relaxed);
+}
+
+void Stats:: setEnabled(bool enabled) {
+    ::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Stats:: count(Counter counter, long long amount) {
+    if (isEnabled()) {
+        counters[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+void Stats:: countPolicy(Counter counter, const SelectionPolicy& policy) {
+    if (!isEnabled()) {
+        return;
+    }
+    // by type, so counting allocates nothing and does not inflate the allocation counters.
+    for (int i = 0; i < 4; i++) {
+        if (typeid(policy) == *policyTypes[i]) {
+            counters[counter + i].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Stats:: time(Timer timer, long long nanoseconds) {
+    if (isEnabled()) {
+        timerNanoseconds[timer].fetch_add(nanoseconds, std::memory_order_relaxed);
+        timerCalls[timer].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Stats:: recordCommand(const BaseAction& action, long long nanoseconds) {
+    if (!isEnabled()) {
+        return;
+    }
+    string description = action.toString();
+    string name = description.substr(0, description.find(' '));
+    int bucket = 0;
+    while (bucket < numOfBuckets - 1 && (1LL << (bucket + 1)) <= nanoseconds) {
+        bucket++;
+    }
+    std::lock_guard<std::mutex> lock(commandsLock);
+    if (commandLatencies == nullptr) {
+        commandLatencies = new std::map<string, LatencyHistogram>();
+    }
+    LatencyHistogram& histogram = (*commandLatencies)[name];
+    histogram.count++;
+    histogram.totalNanoseconds += nanoseconds;
+    histogram.buckets[bucket]++;
+}
+
+void Stats:: reset() {
+    for (std::atomic<long long>& counter: counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < NUM_OF_TIMERS; i++) {
+        timerNanoseconds[i].store(0, std::memory_order_relaxed);
+        timerCalls[i].store(0, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(commandsLock);
+    if (commandLatencies != nullptr) {
+        commandLatencies->clear();
+    }
+}
+
+// Upper bound of the bucket that holds the given fraction of the samples.
+static long long percentile(const LatencyHistogram& histogram, double fraction) {
+    long long target = (long long)(histogram.count * fraction);
+    long long seen = 0;
+    for (int bucket = 0; bucket < numOfBuckets; bucket++) {
+        seen += histogram.buckets[bucket];
+        if (seen > target) {
+            return 1LL << (bucket + 1);
+        }
+    }
+    return 1LL << numOfBuckets;
+}
+
+void Stats:: print(std::ostream& out, const Simulation& simulation) {
+    out << "Statistics: " << (isEnabled() ? "enabled" : "disabled") << endl;
+    out << "FacilitiesSelected:";
+    for (int i = 0; i < 4; i++) {
+        out << " " << policyNames[i] << "=" << counters[FACILITIES_SELECTED + i].load();
+    }
+    out << endl << "FacilitiesCompleted:";
+    for (int i = 0; i < 4; i++) {
+        out << " " << policyNames[i] << "=" << counters[FACILITIES_COMPLETED + i].load();
+    }
+    int available = 0, busy = 0;
+    for (const Plan& plan: simulation.getPlans()) {
+        if (plan.getStatus() == PlanStatus:: AVALIABLE) {
+            available++;
+        }else {
+            busy++;
+        }
+    }
+    out << endl << "Plans: AVALIABLE=" << available << " BUSY=" << busy << endl;
+    for (int i = 0; i < NUM_OF_TIMERS; i++) {
+        long long calls = timerCalls[i].load();
+        long long nanoseconds = timerNanoseconds[i].load();
+        out << "Time " << timerNames[i] << ": calls=" << calls << " totalUs=" << nanoseconds / 1000
+            << " nsPerCall=" << (calls == 0 ? 0 : nanoseconds / calls) << endl;
+    }
+    out << "Allocations: count=" << counters[ALLOCATIONS].load() << " bytes=" << counters[ALLOCATED_BYTES].load() << endl;
+    out << "Journal: commands=" << counters[JOURNALED_COMMANDS].load() << " syncs=" << timerCalls[JOURNAL_SYNC].load() << endl;
+    std::lock_guard<std::mutex> lock(commandsLock);
+    if (commandLatencies == nullptr) {
+        return;
+    }
+    for (const std::pair<const string, LatencyHistogram>& item: *commandLatencies) {
+        const LatencyHistogram& histogram = item.second;
+        out << "Command " << item.first << ": count=" << histogram.count << " meanNs=" << histogram.totalNanoseconds / histogram.count
+            << " p50Ns<" << percentile(histogram, 0.5) << " p90Ns<" << percentile(histogram, 0.9)
+            << " p99Ns<" << percentile(histogram, 0.99) << endl;
+    }
+}
+
+// the clock is read only while statistics are enabled.
+Stats::ScopedTimer:: ScopedTimer(Timer timer): timer(timer), timed(isEnabled()), begin(timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+Stats::ScopedTimer:: ~ScopedTimer() {
+    if (timed) {
+        Stats::time(timer, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+    }
+}
@@ -0,0 +1,108 @@
+#include "Sweep.h"
+#include "Action.h"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+using std::cout;
+using std::endl;
+
+Sweep:: Sweep(const string& configFilePath, const string& sweepFilePath)
+: base(configFilePath), variantNames(), variantActions() {
+    std::ifstream inputFile(sweepFilePath);
+
+    string line;
+    vector<ArgumentView> command;
+    while (std::getline(inputFile, line)) {
+        Auxiliary:: parseArguments(line, command);
+        if (command.empty() || command[0].data[0] == '#') {
+            continue;
+        }
+        if (command[0] == "variant" && command.size() == 2) {
+            variantNames.push_back(command[1].toString());
+            variantActions.push_back(vector<BaseAction*>());
+            continue;
+        }
+        if (command[0] == "close" || command[0] == "log") {
+            cout << "Not available in a sweep: " << command[0] << endl;
+            continue;
+        }
+        BaseAction* action = Simulation:: parseAction(command);
+        if (action == nullptr) {
+            cout << "Unknown command: " << command[0] << endl;
+        }else if (variantActions.empty()) {
+            action->act(base);
+        }else {
+            variantActions.back().push_back(action);
+        }
+    }
+    inputFile.close();
+}
+
+int Sweep:: getNumOfVariants() const {
+    return (int)variantNames.size();
+}
+
+SweepResult Sweep:: runVariant(int variantIndex) const {
+    Simulation simulation(base);
+    std::ostream discard(nullptr);
+    simulation.setOutput(discard);
+
+    SweepResult result;
+    for (const BaseAction* item: variantActions[variantIndex]) {
+        BaseAction* action = item->clone();
+        action->act(simulation);
+        if (action->getStatus() == ActionStatus:: ERROR) {
+            result.errors++;
+        }
+    }
+    for (const Plan& plan: simulation.getPlans()) {
+        SweepRow row = {plan.getPlanId(), plan.getSettlement().getName(), plan.getSelectionPolicy()->toString(),
+            plan.getlifeQualityScore(), plan.getEconomyScore(), plan.getEnvironmentScore()};
+        result.rows.push_back(row);
+    }
+    return result;
+}
+
+void Sweep:: run(int numOfThreads, std::ostream& out) const {
+    vector<SweepResult> results(variantNames.size());
+    std::atomic<int> nextVariant(0);
+    if (numOfThreads < 1) {
+        numOfThreads = 1;
+    }
+
+    vector<std::thread> workers;
+    for (int i = 0; i < numOfThreads && i < getNumOfVariants(); i++) {
+        workers.push_back(std::thread([this, &results, &nextVariant]() {
+            for (int variant = nextVariant++; variant < getNumOfVariants(); variant = nextVariant++) {
+                results[variant] = runVariant(variant);
+            }
+        }));
+    }
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+
+    out << "variant\tplanId\tsettlement\tpolicy\tLifeQualityScore\tEconomyScore\tEnvironmentScore" << endl;
+    for (int variant = 0; variant < getNumOfVariants(); variant++) {
+        int totalLifeQuality = 0, totalEconomy = 0, totalEnvironment = 0;
+        for (const SweepRow& row: results[variant].rows) {
+            out << variantNames[variant] << "\t" << row.planId << "\t" << row.settlementName << "\t" << row.selectionPolicy
+                << "\t" << row.lifeQualityScore << "\t" << row.economyScore << "\t" << row.environmentScore << endl;
+            totalLifeQuality += row.lifeQualityScore;
+            totalEconomy += row.economyScore;
+            totalEnvironment += row.environmentScore;
+        }
+        out << variantNames[variant] << "\ttotal\t-\t" << results[variant].errors << " errors"
+            << "\t" << totalLifeQuality << "\t" << totalEconomy << "\t" << totalEnvironment << endl;
+    }
+}
+
+Sweep:: ~Sweep() {
+    for (vector<BaseAction*>& actions: variantActions) {
+        for (BaseAction* action: actions) {
+            delete action;
+        }
+        actions.clear();
+    }
+}
@@ -1,21 +1,77 @@
 #include "Simulation.h"
+#include "Sweep.h"
+#include "ShardCoordinator.h"
+#include "Server.h"
+#include "Host.h"
+#include "CatalogFile.h"
 #include <iostream>
+#include <thread>
 
 using namespace std;
 
-Simulation* backup = nullptr;
-
 int main(int argc, char** argv){
-    if(argc!=2){
-        cout << "usage: simulation <config_path>" << endl;
+    if(argc >= 4 && string(argv[1]) == "--sweep"){
+        int numOfThreads = argc >= 5 ? std::stoi(argv[4]) : (int)std::thread::hardware_concurrency();
+        Sweep sweep(argv[2], argv[3]);
+        sweep.run(numOfThreads, cout);
+        return 0;
+    }
+    if(argc == 4 && string(argv[1]) == "--shards"){
+        ShardCoordinator coordinator(argv[3], std::stoi(argv[2]));
+        coordinator.start();
         return 0;
     }
-    string configurationFile = argv[1];
+    if(argc == 4 && string(argv[1]) == "--serve"){
+        Server server(argv[2], argv[3]);
+        return server.run() ? 0 : 1;
+    }
+    if(argc >= 3 && string(argv[1]) == "--host"){
+        int numOfWorkers = argc >= 4 ? std::stoi(argv[3]) : (int)std::thread::hardware_concurrency();
+        Host host(argv[2], numOfWorkers);
+        host.start();
+        return 0;
+    }
+    if(argc == 4 && string(argv[1]) == "--compile-catalog"){
+        Simulation simulation(argv[2]);
+        if (!CatalogFile::compile(*simulation.getCatalog(), argv[3])) {
+            cout << "Cannot write " << argv[3] << endl;
+            return 1;
+        }
+        cout << "Compiled " << simulation.getCatalog()->size() << " facilities into " << argv[3] << endl;
+        return 0;
+    }
+    bool lazySteps = false;
+    bool backgroundBackups = false;
+    string journalFile;
+    int argument = 1;
+    for (; argument < argc - 1; argument++) {
+        if (string(argv[argument]) == "--lazy") {
+            lazySteps = true;
+        }else if (string(argv[argument]) == "--background-backups") {
+            backgroundBackups = true;
+        }else if (string(argv[argument]) == "--journal" && argument < argc - 2) {
+            journalFile = argv[++argument];
+        }else {
+            break;
+        }
+    }
+    if(argc < 2 || argument != argc - 1){
+        cout << "usage: simulation [--lazy] [--background-backups] [--journal <journal_path>] <config_path>" << endl;
+        cout << "       simulation --sweep <config_path> <sweep_path> [threads]" << endl;
+        cout << "       simulation --shards <num_of_shards> <config_path>" << endl;
+        cout << "       simulation --serve <config_path> <socket_path>" << endl;
+        cout << "       simulation --host <tenants_path> [threads]" << endl;
+        cout << "       simulation --compile-catalog <config_path> <catalog_path>" << endl;
+        return 0;
+    }
+    string configurationFile = argv[argc - 1];
     Simulation simulation(configurationFile);
-    simulation.start();
-    if(backup!=nullptr){
-    	delete backup;
-    	backup = nullptr;
+    simulation.setLazySteps(lazySteps);
+    simulation.setBackgroundBackups(backgroundBackups);
+    if (!journalFile.empty() && !simulation.openJournal(journalFile)) {
+        cout << "Cannot open " << journalFile << endl;
+        return 1;
     }
+    simulation.start();
     return 0;
 }